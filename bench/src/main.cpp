@@ -0,0 +1,666 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <Magick++.h>
+
+#include <atk/astc.h>
+#include <atk/buffer_pool.h>
+#include <atk/ktx_reader.h>
+#include <atk/ktx_writer.h>
+#include <atk/magick.h>
+#include <atk/metrics.h>
+#include <atk/mipmap.h>
+#include <atk/texture.h>
+#include <atk/thread_pool.h>
+#include <atk/util.h>
+
+#if defined(_WIN32)
+#	define popen _popen
+#	define pclose _pclose
+#endif
+
+/// @brief Benchmark parameters
+struct BenchConfig
+{
+	/// Runs of each measure
+	size_t repetitions = 5;
+
+	/// Whether to add the 4096x4096 synthetic images
+	bool large = false;
+
+	/// Only stages containing this string are measured, all when empty
+	std::string filter = {};
+
+	/// Where to write results as JSON, nowhere when empty
+	std::string json_path = {};
+
+	/// Whether to measure thread scaling
+	bool thread_scaling = false;
+
+	/// Threads of the pool, zero to use every available core
+	uint32_t thread_count = 0;
+
+	/// Path of this benchmark, run again for the measures which need a fresh process
+	std::string program = {};
+
+	/// Measure to print the seconds of when running as a child process, none when empty
+	std::string child = {};
+
+	/// Corpus image paths
+	std::vector<std::string> images = {};
+};
+
+/// @brief Times of the runs of a measure
+struct Timing
+{
+	double median = 0.0;
+
+	double p95 = 0.0;
+};
+
+/// @brief Outcome of a measure
+struct Result
+{
+	std::string stage;
+
+	std::string image;
+
+	uint32_t width = 0;
+
+	uint32_t height = 0;
+
+	/// Stage parameters, such as block size and preset
+	std::string params;
+
+	Timing timing;
+
+	/// Peak resident memory of the process after the measure
+	double peak_rss_mib = 0.0;
+
+	/// Quality of the encoded image, zero when not measured
+	double psnr = 0.0;
+};
+
+/// @return The peak resident memory of the process in MiB
+double get_peak_rss_mib()
+{
+	return atk::get_peak_rss() / (1024.0 * 1024.0);
+}
+
+/// @brief Runs a function several times
+/// @return The median and 95th percentile time of a run in seconds
+template <typename Func>
+Timing measure(Func &&func, size_t repetitions = 3)
+{
+	std::vector<double> times;
+	for (size_t i = 0; i < repetitions; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		times.emplace_back(elapsed.count());
+	}
+
+	std::sort(std::begin(times), std::end(times));
+
+	Timing timing;
+	timing.median = times[times.size() / 2];
+	timing.p95    = times[std::min(times.size() - 1, static_cast<size_t>(std::ceil(0.95 * times.size())) - 1)];
+	return timing;
+}
+
+/// @brief Runs this benchmark in a child process, where neither the thread pool nor the codec tables are set up yet
+/// @param[in] args Arguments of the child, which prints the seconds of its measure
+/// @return The seconds printed by the child
+std::vector<double> run_child(const BenchConfig &config, const std::string &args)
+{
+	auto command = "\"" + config.program + "\" -repetitions " + std::to_string(config.repetitions) + " " + args;
+
+	auto pipe = popen(command.c_str(), "r");
+	if (!pipe)
+	{
+		throw std::runtime_error{"Cannot run [" + command + "]"};
+	}
+
+	std::string output;
+	char        buffer[256];
+	while (std::fgets(buffer, sizeof(buffer), pipe))
+	{
+		output += buffer;
+	}
+
+	if (pclose(pipe) != 0)
+	{
+		throw std::runtime_error{"Failed to run [" + command + "]"};
+	}
+
+	std::istringstream  stream{output};
+	std::vector<double> times;
+	double              time;
+	while (stream >> time)
+	{
+		times.emplace_back(time);
+	}
+	return times;
+}
+
+/// @brief Measures how astc encoding scales from one thread to every available core.
+///        The thread count of a pool is set before its first use, so each count runs in its own process
+void bench_thread_scaling(const BenchConfig &config, const std::string &image_path)
+{
+	auto max_threads = atk::get_available_thread_count();
+
+	std::vector<uint32_t> thread_counts;
+	for (uint32_t count = 1; count < max_threads; count *= 2)
+	{
+		thread_counts.emplace_back(count);
+	}
+	thread_counts.emplace_back(max_threads);
+
+	auto image   = atk::MagickImage{image_path};
+	auto mpixels = image.get_width() * image.get_height() / 1000000.0;
+
+	std::cout << "threads\tseconds\tMPix/s\tspeedup\n";
+
+	double single_thread_time = 0.0;
+	for (auto count : thread_counts)
+	{
+		auto times = run_child(config, "-child encode -threads " + std::to_string(count) + " \"" + image_path + "\"");
+		if (times.size() != 1)
+		{
+			throw std::runtime_error{"Invalid thread scaling measure"};
+		}
+
+		auto time = times.front();
+		if (count == 1)
+		{
+			single_thread_time = time;
+		}
+
+		std::cout << count << "\t" << time << "\t" << mpixels / time << "\t" << single_thread_time / time << "\n";
+	}
+}
+
+
+/// @brief Kinds of synthetic content, each one stressing the encoder differently
+enum class Content
+{
+	Gradient,
+	Noise,
+	Flat,
+	Tiles
+};
+
+const char *get_name(const Content content)
+{
+	switch (content)
+	{
+		case Content::Gradient:
+			return "gradient";
+		case Content::Noise:
+			return "noise";
+		case Content::Flat:
+			return "flat";
+		case Content::Tiles:
+			return "tiles";
+	}
+	return "unknown";
+}
+
+/// @return A new sRGB RGBA8 image filled with synthetic content
+atk::Image create_synthetic_image(const Content content, const uint32_t size)
+{
+	auto data = new uint8_t[size_t(size) * size * 4];
+
+	uint32_t state = 0x12345678;
+	for (uint32_t y = 0; y < size; ++y)
+	{
+		for (uint32_t x = 0; x < size; ++x)
+		{
+			auto texel = data + (size_t(y) * size + x) * 4;
+			switch (content)
+			{
+				case Content::Gradient:
+					texel[0] = uint8_t(x * 255 / size);
+					texel[1] = uint8_t(y * 255 / size);
+					texel[2] = uint8_t((x + y) * 127 / size);
+					texel[3] = 255;
+					break;
+				case Content::Noise:
+					for (uint32_t c = 0; c < 4; ++c)
+					{
+						state    = state * 1664525u + 1013904223u;
+						texel[c] = uint8_t(state >> 24);
+					}
+					break;
+				case Content::Flat:
+					texel[0] = 90;
+					texel[1] = 140;
+					texel[2] = 200;
+					texel[3] = 255;
+					break;
+				case Content::Tiles:
+					// Checkers of 32x32 texels, repeated so that most blocks are duplicates
+					texel[0] = ((x / 32 + y / 32) % 2) ? 220 : 30;
+					texel[1] = uint8_t(x % 32 * 8);
+					texel[2] = uint8_t(y % 32 * 8);
+					texel[3] = 255;
+					break;
+			}
+		}
+	}
+
+	return atk::Image{data, size_t(size) * size * 4, size, size, 1, GL_SRGB8_ALPHA8};
+}
+
+/// @brief Image to measure, with its encoded form so loading can be measured too
+struct BenchImage
+{
+	std::string name;
+
+	/// Path of a corpus image, empty for synthetic ones
+	std::string path;
+
+	/// Synthetic images encoded to PNG in memory
+	Magick::Blob png;
+};
+
+/// @brief Collects results, printing them as they come
+class Bench
+{
+  public:
+	Bench(const BenchConfig &c) :
+	    config{c}
+	{
+		std::cout << std::left << std::setw(10) << "stage" << std::setw(24) << "image" << std::setw(22) << "params"
+		          << std::right << std::setw(12) << "median (s)" << std::setw(12) << "p95 (s)" << std::setw(10) << "MPix/s"
+		          << std::setw(10) << "RSS MiB" << std::setw(8) << "PSNR" << "\n";
+	}
+
+	/// @brief Measures a stage unless it is filtered out
+	/// @param[in] func Function to measure
+	/// @param[in] psnr Computes the quality of the result, can be empty
+	void run(const std::string &stage, const std::string &image, const atk::Image &source, const std::string &params,
+	         const std::function<void()> &func, const std::function<double()> &psnr = {})
+	{
+		if (!config.filter.empty() && stage.find(config.filter) == std::string::npos)
+		{
+			return;
+		}
+
+		Result result;
+		result.stage        = stage;
+		result.image        = image;
+		result.width        = source.get_width();
+		result.height       = source.get_height();
+		result.params       = params;
+		result.timing       = measure(func, config.repetitions);
+		result.peak_rss_mib = get_peak_rss_mib();
+		result.psnr         = psnr ? psnr() : 0.0;
+
+		auto mpixels = result.width * double(result.height) / 1000000.0;
+
+		std::cout << std::left << std::setw(10) << stage << std::setw(24) << image << std::setw(22) << params
+		          << std::right << std::fixed << std::setprecision(4) << std::setw(12) << result.timing.median
+		          << std::setw(12) << result.timing.p95 << std::setprecision(1) << std::setw(10) << mpixels / result.timing.median
+		          << std::setw(10) << result.peak_rss_mib << std::setw(8);
+		if (result.psnr != 0.0)
+		{
+			std::cout << result.psnr;
+		}
+		std::cout << std::defaultfloat << "\n";
+
+		results.emplace_back(result);
+	}
+
+	/// @brief Writes every result as JSON
+	void write_json(const std::string &path) const;
+
+  private:
+	const BenchConfig &config;
+
+	std::vector<Result> results;
+};
+
+
+void Bench::write_json(const std::string &path) const
+{
+	std::ofstream file{path};
+	if (!file)
+	{
+		throw std::runtime_error{"Cannot write [" + path + "]"};
+	}
+
+	file << "{\n";
+	file << "  \"version\": " << atk::quote_json(atk::get_version()) << ",\n";
+	file << "  \"threads\": " << atk::ThreadPool::get_default().get_thread_count() << ",\n";
+	file << "  \"repetitions\": " << config.repetitions << ",\n";
+	file << "  \"peak_rss_mib\": " << get_peak_rss_mib() << ",\n";
+	file << "  \"results\": [\n";
+
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		auto &r       = results[i];
+		auto  mpixels = r.width * double(r.height) / 1000000.0;
+
+		file << "    {\"stage\": " << atk::quote_json(r.stage) << ", \"image\": " << atk::quote_json(r.image)
+		     << ", \"width\": " << r.width << ", \"height\": " << r.height << ", \"params\": " << atk::quote_json(r.params)
+		     << ", \"median_s\": " << r.timing.median << ", \"p95_s\": " << r.timing.p95
+		     << ", \"mpix_per_s\": " << mpixels / r.timing.median << ", \"peak_rss_mib\": " << r.peak_rss_mib;
+		if (r.psnr != 0.0)
+		{
+			file << ", \"psnr\": " << (std::isinf(r.psnr) ? 999.0 : r.psnr);
+		}
+		file << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+
+	file << "  ]\n}\n";
+}
+
+/// @brief Measures every stage of the conversion of an image
+void bench_image(Bench &bench, const BenchImage &bench_image)
+{
+	auto &name = bench_image.name;
+
+	auto load = [&bench_image] {
+		auto image = bench_image.path.empty() ? atk::MagickImage{Magick::Image{bench_image.png}} : atk::MagickImage{bench_image.path};
+		image.get_data();
+		return image;
+	};
+
+	auto image = load();
+	bench.run("load", name, image, "", [&load] { load(); });
+
+	bench.run("rgba", name, image, "", [&load] {
+		auto image = load();
+		image.convert(atk::Format::RGBA);
+		image.get_data();
+	});
+
+	image.convert(atk::Format::RGBA);
+
+	// A raw copy, so later stages do not depend on ImageMagick
+	auto data = new uint8_t[image.get_size()];
+	std::copy(image.get_data(), image.get_data() + image.get_size(), data);
+	auto rgba = atk::Image{data, image.get_size(), image.get_width(), image.get_height(), 1, image.get_gl_format()};
+
+	bench.run("mipmaps", name, rgba, "native", [&rgba] {
+		std::unique_ptr<atk::Image> level;
+		atk::Image *                previous = &rgba;
+		while (previous->get_width() > 1 || previous->get_height() > 1)
+		{
+			level    = atk::generate_mipmap(*previous);
+			previous = level.get();
+		}
+	});
+
+	// Block sizes at a middle preset, then every other preset at 8x8
+	std::vector<std::pair<atk::BlockDim, atk::Preset>> encodings;
+	for (auto block_dim : {atk::BlockDim{4, 4, 1}, atk::BlockDim{6, 6, 1}, atk::BlockDim{8, 8, 1}, atk::BlockDim{12, 12, 1}})
+	{
+		encodings.emplace_back(block_dim, atk::Preset::Medium);
+	}
+	for (auto preset : {atk::Preset::Fastest, atk::Preset::Fast, atk::Preset::Thorough, atk::Preset::Exhaustive})
+	{
+		encodings.emplace_back(atk::BlockDim{8, 8, 1}, preset);
+	}
+
+	for (auto &encoding : encodings)
+	{
+		atk::EncodeOptions options;
+		options.block_dim = encoding.first;
+		options.preset    = encoding.second;
+
+		std::ostringstream params;
+		params << int(options.block_dim.x) << "x" << int(options.block_dim.y) << " " << atk::get_name(options.preset);
+
+		bench.run(
+		    "encode", name, rgba, params.str(), [&rgba, &options] { atk::Astc::encode_from(rgba, options); },
+		    [&rgba, &options] { return atk::measure(rgba, atk::Astc::encode_from(rgba, options).decode()).get_psnr(); });
+	}
+
+	auto astc = atk::Astc::encode_from(rgba);
+	bench.run("decode", name, rgba, "8x8", [&astc] { astc.decode(); });
+
+	auto decoded = astc.decode();
+	bench.run("metrics", name, rgba, "", [&rgba, &decoded] { atk::measure(rgba, decoded); });
+
+	// Whole texture with its mipmaps, uncompressed so that only writing is measured
+	auto ktx_path = atk::get_temporary_path("ktx-creator-bench.ktx");
+
+	auto texels = new uint8_t[rgba.get_size()];
+	std::copy(rgba.get_data(), rgba.get_data() + rgba.get_size(), texels);
+	atk::Texture texture{std::unique_ptr<atk::Image>{new atk::Image{texels, rgba.get_size(), rgba.get_width(), rgba.get_height(), 1, rgba.get_gl_format()}}};
+	texture.generate_mipmap_chain();
+
+	bench.run("ktx-write", name, rgba, "rgba mipmaps", [&texture, &ktx_path] { atk::write_ktx(texture, ktx_path); });
+
+	bench.run("ktx-load", name, rgba, "rgba mipmaps", [&ktx_path] {
+		atk::KtxReader reader{ktx_path};
+
+		// Touch every level, as mapped pages are only read on access
+		uint64_t sum = 0;
+		for (uint32_t level = 0; level < reader.get_level_count(); ++level)
+		{
+			auto image = reader.get_image(level);
+			for (size_t i = 0; i < image->get_size(); i += 4096)
+			{
+				sum += image->get_data()[i];
+			}
+		}
+		volatile uint64_t sink = sum;
+		(void) sink;
+	});
+
+	std::remove(ktx_path.c_str());
+}
+
+/// @return Synthetic images of every content and size
+std::vector<BenchImage> create_synthetic_images(const BenchConfig &config)
+{
+	std::vector<uint32_t> sizes = {256, 1024};
+	if (config.large)
+	{
+		sizes.emplace_back(4096);
+	}
+
+	std::vector<BenchImage> images;
+	for (auto size : sizes)
+	{
+		for (auto content : {Content::Gradient, Content::Noise, Content::Flat, Content::Tiles})
+		{
+			auto raw = create_synthetic_image(content, size);
+
+			Magick::Image magick_image;
+			magick_image.read(size, size, "RGBA", Magick::CharPixel, raw.get_data());
+			magick_image.magick("PNG");
+
+			BenchImage image;
+			image.name = std::string{get_name(content)} + "-" + std::to_string(size);
+			magick_image.write(&image.png);
+			images.emplace_back(image);
+		}
+	}
+
+	return images;
+}
+
+/// @brief Measures the one-time cost of the codec tables and of the first encode of a small texture against
+///        the warm encodes which reuse them. Tables and the thread pool are set up once per process, so each
+///        cold measure runs in a child process of its own
+void bench_startup(const BenchConfig &config)
+{
+	auto tables = run_child(config, "-child startup-tables");
+	auto encode = run_child(config, "-child startup-encode");
+	if (tables.size() != 1 || encode.size() != 2)
+	{
+		throw std::runtime_error{"Invalid startup measure"};
+	}
+
+	auto first = encode[0];
+	auto warm  = encode[1];
+
+	std::cout << "Startup [gradient-64, 6x6]\n";
+	std::cout << "tables\tfirst\twarm\tsaving\n";
+	std::cout << tables[0] << "\t" << first << "\t" << warm << "\t" << 100.0 * (first - warm) / first << "%\n\n";
+}
+
+/// @brief Prints the seconds of the measure of a child process
+void run_child_measure(const BenchConfig &config)
+{
+	// Small texture of the startup measures
+	atk::EncodeOptions startup_options;
+	startup_options.block_dim = {6, 6, 1};
+
+	if (config.child == "encode" && !config.images.empty())
+	{
+		auto image = atk::MagickImage{config.images.front()};
+		image.convert(atk::Format::RGBA);
+		image.get_data();
+
+		std::cout << measure([&image] { atk::Astc::encode_from(image); }, config.repetitions).median << "\n";
+	}
+	else if (config.child == "startup-tables")
+	{
+		std::cout << measure([&startup_options] { atk::prepare_astc_tables(startup_options.block_dim); }, 1).median << "\n";
+	}
+	else if (config.child == "startup-encode")
+	{
+		auto image = create_synthetic_image(Content::Gradient, 64);
+
+		// The first encode sets up the tables and the thread pool
+		auto first = measure([&image, &startup_options] { atk::Astc::encode_from(image, startup_options); }, 1).median;
+		auto warm  = measure([&image, &startup_options] { atk::Astc::encode_from(image, startup_options); }, config.repetitions).median;
+
+		std::cout << first << " " << warm << "\n";
+	}
+	else
+	{
+		throw std::runtime_error{"Invalid child measure [" + config.child + "]"};
+	}
+}
+
+BenchConfig parse_config(int argc, char *argv[])
+{
+	BenchConfig config;
+	config.program = argv[0];
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+
+		if (arg == "-repetitions" && i + 1 < argc)
+		{
+			config.repetitions = std::max<size_t>(std::stoul(argv[++i]), 1);
+		}
+		else if (arg == "-large")
+		{
+			config.large = true;
+		}
+		else if (arg == "-filter" && i + 1 < argc)
+		{
+			config.filter = argv[++i];
+		}
+		else if (arg == "-json" && i + 1 < argc)
+		{
+			config.json_path = argv[++i];
+		}
+		else if (arg == "-thread-scaling")
+		{
+			config.thread_scaling = true;
+		}
+		else if (arg == "-threads" && i + 1 < argc)
+		{
+			config.thread_count = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (arg == "-child" && i + 1 < argc)
+		{
+			config.child = argv[++i];
+		}
+		else
+		{
+			config.images.emplace_back(arg);
+		}
+	}
+
+	// Test corpus, from the root of the repository
+	if (config.images.empty() && config.child.empty())
+	{
+		config.images = {"test/png/lenna.png", "test/png/lenna-alpha.png", "test/png/lenna-npot.png", "test/png/map.png"};
+	}
+
+	return config;
+}
+
+int main(int argc, char *argv[])
+{
+	Magick::InitializeMagick(*argv);
+
+	try
+	{
+		auto config = parse_config(argc, argv);
+
+		// Before anything uses the pool
+		atk::ThreadPool::set_default_thread_count(config.thread_count);
+
+		if (!config.child.empty())
+		{
+			run_child_measure(config);
+			return EXIT_SUCCESS;
+		}
+
+		if (config.filter.empty() || std::string{"startup"}.find(config.filter) != std::string::npos)
+		{
+			bench_startup(config);
+		}
+
+		Bench bench{config};
+
+		for (auto &image : create_synthetic_images(config))
+		{
+			bench_image(bench, image);
+		}
+
+		for (auto &path : config.images)
+		{
+			BenchImage image;
+			image.name = atk::get_basename_no_extension(path);
+			image.path = path;
+			bench_image(bench, image);
+		}
+
+		if (config.thread_scaling)
+		{
+			auto image_path = config.images.empty() ? "test/png/lenna.png" : config.images.front();
+
+			std::cout << "\nThread scaling [" << image_path << "]\n";
+			bench_thread_scaling(config, image_path);
+		}
+
+		auto buffers = atk::BufferPool::get_default().get_stats();
+		std::cout << "\nPeak RSS: " << get_peak_rss_mib() << " MiB, buffers: " << buffers.allocation_count << " ("
+		          << buffers.reuse_count << " reused)\n";
+
+		if (!config.json_path.empty())
+		{
+			bench.write_json(config.json_path);
+			std::cout << "Saved [" << config.json_path << "]\n";
+		}
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "[ERROR] " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
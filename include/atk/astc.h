@@ -20,21 +20,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <iostream>
 #include <vector>
 
 #include <astc_codec_internals.h>
 
-void encode_astc_image(const astc_codec_image * input_image,
-					   astc_codec_image * output_image,
-					   int xdim,
-					   int ydim,
-					   int zdim,
-					   const error_weighting_params * ewp, astc_decode_mode decode_mode, swizzlepattern swz_encode, swizzlepattern swz_decode, uint8_t * buffer, int pack_and_unpack, int threadcount);
-
-void store_astc_file(const astc_codec_image * input_image,
-					 const char *filename, int xdim, int ydim, int zdim, const error_weighting_params * ewp, astc_decode_mode decode_mode, swizzlepattern swz_encode, int threadcount);
-
 #include "atk/image.h"
 
 namespace atk
@@ -48,6 +39,11 @@ struct BlockDim
 	    z{z}
 	{}
 
+	bool operator==(const BlockDim &other) const
+	{
+		return x == other.x && y == other.y && z == other.z;
+	}
+
 	uint8_t x;
 	uint8_t y;
 	uint8_t z;
@@ -63,57 +59,197 @@ struct AstcHeader
 	uint8_t  zsize[3];        // block count is inferred
 };
 
+/// @brief Builds the codec tables of a block footprint, once per process
+///        Later calls return straight away, so tables are shared read-only by every encode and decode
+/// @param[in] block_dim Block footprint
+void prepare_astc_tables(BlockDim block_dim);
+
+/// @return The block dimensions of an astc GL format, zero for other formats
+BlockDim get_block_dim(uint32_t gl_format);
+
+/// @param[in] block_dim Block footprint
+/// @param[in] srgb Whether color channels are sRGB encoded
+/// @return The astc GL format of a block footprint, zero if it is not a valid footprint
+uint32_t get_astc_gl_format(BlockDim block_dim, bool srgb = true);
+
+/// @param[in] footprint Block footprint, such as "6x6" or "4x4x4"
+/// @return The block dimensions of the footprint
+BlockDim parse_block_dim(const std::string &footprint);
+
+/// @brief Encoder presets trading quality for speed, from the fastest to the best quality
+enum class Preset
+{
+	Fastest,
+	Fast,
+	Medium,
+	Thorough,
+	Exhaustive
+};
+
+/// @param[in] name Name of a preset, such as "fast"
+/// @return The preset with that name
+Preset get_preset(const std::string &name);
+
+/// @return The name of a preset
+const char *get_name(Preset preset);
+
+class AstcCache;
+
+/// @brief Counters of the astc encoder
+struct EncodeStats
+{
+	/// Blocks of the encoded images
+	std::atomic<uint64_t> block_count{0};
+
+	/// Blocks of a single color, written as void extent blocks without a search
+	std::atomic<uint64_t> constant_block_count{0};
+
+	/// Blocks identical to a previous block, whose encoding was copied
+	std::atomic<uint64_t> duplicate_block_count{0};
+};
+
+/// @brief Parameters of the astc encoder
+struct EncodeOptions
+{
+	Preset preset = Preset::Thorough;
+
+	/// Footprint of the blocks, any 2D size or 3D OES size
+	BlockDim block_dim = {8, 8, 1};
+
+	/// Whether color channels are sRGB encoded
+	bool srgb = true;
+
+	/// Cache of encoded blocks, none when null
+	AstcCache *cache = nullptr;
+
+	/// Where to count blocks, none when null
+	EncodeStats *stats = nullptr;
+};
+
 class Astc : public Image
 {
   public:
 	/// @brief Encodes an image to astc
 	/// @param[in] file_path Image file path
+	/// @param[in] options Encoder parameters
 	/// @return A new Astc image
-	static Astc encode_from(const std::string &file_path);
+	static Astc encode_from(const std::string &file_path, const EncodeOptions &options = {});
 
 	/// @brief Encodes an image to astc
 	/// @param[in] image Image to encode
+	/// @param[in] options Encoder parameters
 	/// @return A new Astc image
-	static Astc encode_from(Image &image);
-
-	/// @brief Define and retrieve compressed texture image
+	static Astc encode_from(Image &image, const EncodeOptions &options = {});
+
+	/// @brief Encodes several images to astc in a single parallel schedule,
+	///        where tasks are made of the same number of blocks whatever their image
+	/// @param[in] images Images to encode
+	/// @param[in] options Encoder parameters
+	/// @return New Astc images in the same order
+	static std::vector<Astc> encode_from(const std::vector<Image *> &images, const EncodeOptions &options = {});
+
+	/// @brief Encodes several images to astc in a single parallel schedule,
+	///        writing blocks straight into memory provided by the caller, without header
+	/// @param[in] images Images to encode
+	/// @param[out] outputs Where to write the blocks of each image
+	/// @param[in] options Encoder parameters
+	static void encode_to(const std::vector<Image *> &images, const std::vector<uint8_t *> &outputs, const EncodeOptions &options = {});
+
+	/// @brief Define and retrieve compressed texture image,
+	///        the file is memory mapped instead of being read
 	/// @param[in] file_path Astc image file path
 	Astc(const std::string &file_path);
 
-	/// @brief Create astc from raw data without header
-	Astc(uint32_t width, uint32_t height, uint32_t depth, const uint8_t *mem);
+	/// @brief Create astc from raw data without header, which is copied
+	/// @param[in] gl_format Astc GL format giving the block dimensions and color space
+	Astc(uint32_t width, uint32_t height, uint32_t depth, const uint8_t *mem, uint32_t gl_format = GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR);
 
-	/// @brief Create astc from raw data with header
+	/// @brief Create astc from raw data with header allocated with new[], taking ownership of it
 	Astc(const uint8_t *data);
 
-	Astc(Astc &&);
+	/// @brief Creates astc from blocks within a storage, without copying them
+	/// @param[in] storage Storage holding the blocks
+	/// @param[in] offset Where the blocks begin within the storage
+	/// @param[in] gl_format Astc GL format giving the block dimensions and color space
+	Astc(std::shared_ptr<Storage> storage, size_t offset, uint32_t width, uint32_t height, uint32_t depth, uint32_t gl_format);
 
-	~Astc() override;
+	Astc(Astc &&);
 
+	/// @brief Decodes the blocks in parallel to RGBA8 texels
+	/// @return A new image owning the texels
 	Image decode() const;
 
+	/// @brief Decodes the blocks in parallel to RGBA8 texels written straight into a buffer
+	/// @param[out] texels Buffer of at least row_stride * height * depth bytes
+	/// @param[in] row_stride Bytes between two rows of texels, zero for width * 4
+	void decode(uint8_t *texels, size_t row_stride = 0) const;
+
 	void store(const std::string &path) const;
 
 	std::unique_ptr<Image> resize(const uint32_t w, const uint32_t h) override;
 
-	const uint8_t *get_data() const override;
-
 	uint32_t get_xblocks() const;
 
 	uint32_t get_yblocks() const;
 
 	uint32_t get_zblocks() const;
 
-	uint32_t get_gl_format() override
+	/// @return The total number of blocks
+	size_t get_block_count() const;
+
+	/// @return The astc GL format matching the block dimensions and color space
+	uint32_t get_gl_format() override;
+
+	BlockDim get_block_dim() const
 	{
-		return GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR;
+		return block_dim;
 	}
 
   private:
 	Astc() = default;
 
-	/// @brief Used to encode raw data during construction
-	void encode();
+	/// @brief Sets block dimensions and color space from an astc GL format
+	void set_gl_format(uint32_t gl_format);
+
+	/// @brief Sets size and block dimensions from a header
+	void set_header(const AstcHeader &hdr);
+
+	/// @return The header describing this image
+	AstcHeader get_header() const;
+
+	/// @brief Creates astc images with the dimensions and encoder parameters of some images
+	/// @param[in] images Images to encode
+	/// @param[in] options Encoder parameters
+	static std::vector<Astc> create_from(const std::vector<Image *> &images, const EncodeOptions &options);
+
+	/// @brief Sets the size from the dimensions and where blocks are encoded
+	/// @param[in] output Memory for the blocks, when null it is allocated
+	void allocate(uint8_t *output = nullptr);
+
+	/// @brief Encodes a block of the source into the allocated memory
+	/// @param[in] index Index of the block
+	void encode_block(size_t index);
+
+	/// @brief Reads the RGBA8 texels of a block of the source, clamped to its edges
+	/// @param[in] index Index of the block
+	/// @param[out] texels Room for the texels of a block
+	void read_block(size_t index, uint8_t *texels) const;
+
+	/// @param[in] index Index of the block
+	/// @return Number of texels of the block within the source along each axis,
+	///         smaller than the footprint for blocks on the right, bottom or back edges
+	BlockDim get_block_extent(size_t index) const;
+
+	/// @brief Writes a void extent block of a single color into the allocated memory
+	/// @param[in] index Index of the block
+	/// @param[in] rgba Color of the block
+	void encode_constant_block(size_t index, const uint8_t *rgba);
+
+	/// @brief Used to encode raw data during construction, constant blocks are written
+	///        straight away and blocks identical to another one reuse its encoding
+	/// @param[in] astcs Images with the same parameters to encode in a single parallel schedule
+	/// @param[out] stats Where to count blocks, can be null
+	static void encode(const std::vector<Astc *> &astcs, EncodeStats *stats);
 
 	astc_decode_mode decode_mode = DECODE_LDR_SRGB;
 
@@ -123,7 +259,36 @@ class Astc : public Image
 
 	error_weighting_params ewp;
 
-	astc_codec_image *codec_image = nullptr;
+	/// @brief Strided view over texels to encode, the memory belongs to the caller
+	struct Source
+	{
+		const uint8_t *data = nullptr;
+
+		/// Bytes of a texel, 3 for RGB8 and 4 for RGBA8
+		uint32_t texel_size = 4;
+
+		size_t row_stride   = 0;
+		size_t slice_stride = 0;
+
+		/// Whether rows are stored bottom up
+		bool y_flip = false;
+	};
+
+	/// @brief Sets the texels to encode, they must outlive the encoding
+	void set_source(const Source &src);
+
+	/// @brief Sets an RGB8 or RGBA8 image as the texels to encode
+	void set_source(Image &image);
+
+	/// Texels to encode, none when data is null
+	Source source;
+
+	/// Dimensions of the source without texels, the codec reads
+	/// them to ignore texels clamped past the edges of the image
+	astc_codec_image extent = {};
+
+	/// Where blocks are encoded
+	uint8_t *blocks = nullptr;
 };
 
 std::ostream &operator<<(std::ostream &os, const Astc &astc);
@@ -0,0 +1,94 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "atk/astc.h"
+
+namespace atk
+{
+/// @brief On-disk cache of encoded astc blocks, addressed by the hash of the
+///        texels and of the encoder parameters. Entries are written atomically,
+///        so several processes can share a cache directory, and the least
+///        recently used ones are evicted when the cache exceeds its size.
+class AstcCache
+{
+  public:
+	/// @param[in] directory Where entries are stored, created if missing
+	/// @param[in] max_size Maximum size in bytes of all the entries
+	AstcCache(const std::string &directory, uint64_t max_size = 1ull << 30);
+
+	AstcCache(const AstcCache &) = delete;
+
+	AstcCache &operator=(const AstcCache &) = delete;
+
+	/// @param[in] image RGBA8 image to encode
+	/// @param[in] options Encoder parameters
+	/// @return The key of the blocks encoding an image with some parameters
+	static std::string get_key(const Image &image, const EncodeOptions &options);
+
+	/// @brief Copies the blocks of an entry and marks it as recently used
+	/// @param[in] key Key of the entry
+	/// @param[out] blocks Where to copy the blocks
+	/// @param[in] size Expected size in bytes of the blocks
+	/// @return Whether the entry was found
+	bool load(const std::string &key, uint8_t *blocks, size_t size);
+
+	/// @brief Adds an entry, then evicts the least recently used ones if the cache is full
+	/// @param[in] key Key of the entry
+	/// @param[in] blocks Encoded blocks
+	/// @param[in] size Size in bytes of the blocks
+	void store(const std::string &key, const uint8_t *blocks, size_t size);
+
+	uint64_t get_hit_count() const;
+
+	uint64_t get_miss_count() const;
+
+  private:
+	/// @return The path of an entry
+	std::string get_path(const std::string &key) const;
+
+	/// @brief Computes the size of the entries from the directory
+	uint64_t scan() const;
+
+	/// @brief Removes the least recently used entries until the cache is below its size
+	void evict();
+
+	std::string directory;
+
+	uint64_t max_size;
+
+	/// Estimated size of the entries, other processes may add some
+	std::atomic<uint64_t> size{0};
+
+	std::atomic<uint64_t> hit_count{0};
+
+	std::atomic<uint64_t> miss_count{0};
+
+	/// Only one eviction at a time within a process
+	std::mutex eviction_mutex;
+};
+
+}        // namespace atk
@@ -0,0 +1,103 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace atk
+{
+/// @brief Queue between two stages of a pipeline, producers wait while it is full
+///        so a fast stage cannot pile up the work of a slow one
+template <typename T>
+class BoundedQueue
+{
+  public:
+	/// @param[in] capacity Maximum number of items waiting in the queue
+	BoundedQueue(size_t capacity) :
+	    capacity{capacity > 0 ? capacity : 1}
+	{}
+
+	BoundedQueue(const BoundedQueue &) = delete;
+
+	BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+	/// @brief Waits for room in the queue and adds an item
+	/// @return False when the queue was closed, the item is then left untouched
+	bool push(T &&item)
+	{
+		std::unique_lock<std::mutex> lock{mutex};
+		not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+		if (closed)
+		{
+			return false;
+		}
+
+		items.emplace_back(std::move(item));
+		not_empty.notify_one();
+		return true;
+	}
+
+	/// @brief Waits for an item and removes it from the queue
+	/// @param[out] item The item removed
+	/// @return False when the queue is closed and there are no items left
+	bool pop(T &item)
+	{
+		std::unique_lock<std::mutex> lock{mutex};
+		not_empty.wait(lock, [this] { return closed || !items.empty(); });
+		if (items.empty())
+		{
+			return false;
+		}
+
+		item = std::move(items.front());
+		items.pop_front();
+		not_full.notify_one();
+		return true;
+	}
+
+	/// @brief Stops accepting items, consumers still get the items left
+	void close()
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		closed = true;
+		not_full.notify_all();
+		not_empty.notify_all();
+	}
+
+  private:
+	const size_t capacity;
+
+	std::deque<T> items;
+
+	bool closed = false;
+
+	std::mutex mutex;
+
+	std::condition_variable not_full;
+
+	std::condition_variable not_empty;
+};
+
+}        // namespace atk
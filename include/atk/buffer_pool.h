@@ -0,0 +1,157 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "atk/storage.h"
+
+namespace atk
+{
+class BufferPool;
+
+/// @brief Memory of a buffer pool, returned to it when the storage is destroyed
+class PooledStorage : public Storage
+{
+  public:
+	PooledStorage(const PooledStorage &) = delete;
+
+	PooledStorage &operator=(const PooledStorage &) = delete;
+
+	~PooledStorage() override;
+
+	const uint8_t *get_data() const override;
+
+	size_t get_size() const override;
+
+	/// @return The beginning of the memory, for writing
+	uint8_t *get_buffer();
+
+  private:
+	friend class BufferPool;
+
+	PooledStorage(BufferPool &p, uint8_t *d, size_t s, size_t c, bool m);
+
+	BufferPool &pool;
+
+	uint8_t *data = nullptr;
+
+	/// Requested size
+	size_t size = 0;
+
+	/// Size of the size class the memory belongs to
+	size_t capacity = 0;
+
+	/// Whether the memory is a mapping which can be backed by huge pages
+	bool mapped = false;
+};
+
+/// @brief Pool of 64 byte aligned buffers grouped in size classes, so that
+///        buffers of a level or a file are reused by the following ones
+class BufferPool
+{
+  public:
+	/// @brief Alignment of every buffer, enough for any SIMD load
+	static const size_t alignment = 64;
+
+	/// @brief Counters of the pool
+	struct Stats
+	{
+		/// Buffers requested
+		uint64_t allocation_count = 0;
+
+		/// Buffers served from the pool
+		uint64_t reuse_count = 0;
+
+		/// Buffers allocated from the system
+		uint64_t system_allocation_count = 0;
+
+		/// Bytes of the buffers in use
+		size_t used_size = 0;
+
+		/// Highest used size
+		size_t peak_used_size = 0;
+
+		/// Bytes of the buffers kept for reuse
+		size_t cached_size = 0;
+	};
+
+	/// @param[in] max_cached_size Bytes of free buffers kept for reuse, the others go back to the system
+	BufferPool(size_t max_cached_size = size_t(256) << 20);
+
+	BufferPool(const BufferPool &) = delete;
+
+	BufferPool &operator=(const BufferPool &) = delete;
+
+	/// @brief Frees the cached buffers, the pool must outlive the storages it allocated
+	~BufferPool();
+
+	/// @param[in] size Size of the buffer in bytes
+	/// @return A storage with at least size bytes of uninitialized memory
+	std::shared_ptr<PooledStorage> allocate(size_t size);
+
+	/// @brief Frees every cached buffer
+	void trim();
+
+	/// @param[in] size Buffers from this size are backed by huge pages where
+	///                 the system supports them, zero to disable huge pages
+	void set_huge_page_threshold(size_t size);
+
+	Stats get_stats() const;
+
+	/// @return The pool used by the library, it is never destroyed
+	static BufferPool &get_default();
+
+  private:
+	friend class PooledStorage;
+
+	/// @brief Takes a buffer back, keeping it for reuse when there is room
+	void release(uint8_t *data, size_t capacity, bool mapped);
+
+	/// @brief Frees a buffer to the system
+	static void free_buffer(uint8_t *data, size_t capacity, bool mapped);
+
+	struct Buffer
+	{
+		uint8_t *data = nullptr;
+
+		size_t capacity = 0;
+
+		bool mapped = false;
+	};
+
+	mutable std::mutex mutex;
+
+	/// Free buffers, the last one of a size class is reused first
+	std::vector<Buffer> free_buffers;
+
+	size_t max_cached_size = 0;
+
+	size_t huge_page_threshold = size_t(32) << 20;
+
+	Stats stats;
+};
+
+}        // namespace atk
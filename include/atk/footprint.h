@@ -0,0 +1,60 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "atk/astc.h"
+#include "atk/image.h"
+
+namespace atk
+{
+/// @brief Footprint picked to meet a quality target
+struct FootprintChoice
+{
+	BlockDim block_dim = {4, 4, 1};
+
+	/// PSNR in dB of the trial encode with this footprint
+	double psnr = 0.0;
+
+	/// Whether the trial met the target, when no footprint does the smallest one is picked
+	bool met = false;
+};
+
+/// @brief Copies tiles spread over an image into a smaller RGBA image, small images are copied whole.
+///        Tiles keep the details of the image, which downsampling would blur. Magick images only
+///        export the rows of the tiles
+/// @param[in] image 8 bit RGB or RGBA image, left in its format
+/// @return The proxy image
+Image sample_tiles(Image &image);
+
+/// @return The 2D footprints tried by select_footprint, from the lowest bitrate to the highest
+const std::vector<BlockDim> &get_footprint_candidates();
+
+/// @brief Encodes a proxy of an image with 2D footprints from the largest one, the lowest
+///        bitrate, and picks the first whose PSNR meets a target
+/// @param[in] image 8 bit RGB or RGBA image, left in its format
+/// @param[in] target_psnr Minimum PSNR in dB
+/// @param[in] options Encoder parameters of the trials, except for the footprint
+/// @return The footprint picked and its PSNR
+FootprintChoice select_footprint(Image &image, double target_psnr, const EncodeOptions &options);
+
+}        // namespace atk
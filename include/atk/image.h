@@ -30,6 +30,8 @@
 
 #include <gl_format.h>
 
+#include "atk/storage.h"
+
 namespace atk
 {
 /// @brief Supported format
@@ -46,38 +48,51 @@ class Image
 {
   public:
 	Image() = default;
-	Image(uint8_t *dt, size_t s, uint32_t w, uint32_t h, uint32_t d = 1) :
+
+	/// @brief Creates an image owning its data
+	/// @param[in] dt Data allocated with new[]
+	Image(uint8_t *dt, size_t s, uint32_t w, uint32_t h, uint32_t d = 1, uint32_t f = GL_RGBA) :
+	    storage{dt ? std::make_shared<HeapStorage>(dt, s) : nullptr},
 	    data{dt},
 	    size{s},
 	    width{w},
 	    height{h},
-	    depth{d}
+	    depth{d},
+	    gl_format{f}
 	{}
 
+	/// @brief Creates an image whose data lies within a storage
+	/// @param[in] st Storage holding the data, it can be shared with other images
+	/// @param[in] offset Where the data begins within the storage
+	Image(std::shared_ptr<Storage> st, size_t offset, size_t s, uint32_t w, uint32_t h, uint32_t d = 1, uint32_t f = GL_RGBA) :
+	    storage{std::move(st)},
+	    data{storage->get_data() + offset},
+	    size{s},
+	    width{w},
+	    height{h},
+	    depth{d},
+	    gl_format{f}
+	{
+		assert(offset + s <= storage->get_size() && "Image data exceeds its storage");
+	}
+
 	Image(Image &&o) :
+	    storage{std::move(o.storage)},
 	    data{o.data},
 	    size{o.size},
 	    width{o.width},
 	    height{o.height},
-	    depth{o.depth}
+	    depth{o.depth},
+	    gl_format{o.gl_format}
 	{
 		o.data = nullptr;
 	}
 
-	virtual ~Image()
-	{
-		if (data)
-		{
-			delete[] data;
-		}
-	}
+	virtual ~Image() = default;
 
-	/// @brief Converts image format
+	/// @brief Converts image format, raw images can switch between RGB and RGBA
 	/// @param format Format to apply
-	virtual void convert(Format format)
-	{
-		throw std::runtime_error{"Unimplemented"};
-	}
+	virtual void convert(Format format);
 
 	virtual void store(const std::string &path)
 	{}
@@ -116,15 +131,16 @@ class Image
 		return depth;
 	}
 
-	/// @brief Diff with another image
-	/// @param[in] b Other image to compare with
-	/// @return [0, 1] where 0 means they are the same image
-	float diff(const Image &b) const;
-
 	/// @return The GL format used by the KTX header
 	virtual uint32_t get_gl_format()
 	{
-		return GL_RGB;
+		return gl_format;
+	}
+
+	/// @return The storage holding the image data, null when the image does not use one
+	const std::shared_ptr<Storage> &get_storage() const
+	{
+		return storage;
 	}
 
   protected:
@@ -133,10 +149,14 @@ class Image
 		return data;
 	}
 
-	void set_memory(const uint8_t *d)
+	/// @brief Sets the storage holding the image data
+	/// @param[in] st Storage holding the data
+	/// @param[in] offset Where the data begins within the storage
+	void set_storage(std::shared_ptr<Storage> st, size_t offset = 0)
 	{
 		assert(data == nullptr && "Image data was already set");
-		data = d;
+		storage = std::move(st);
+		data    = storage->get_data() + offset;
 	}
 
 	void set_size(size_t s)
@@ -160,6 +180,9 @@ class Image
 	}
 
   private:
+	/// Memory backing the data
+	std::shared_ptr<Storage> storage;
+
 	/// Image memory data
 	const uint8_t *data = nullptr;
 
@@ -168,6 +191,15 @@ class Image
 	uint32_t width  = 0;
 	uint32_t height = 0;
 	uint32_t depth  = 1;
+
+	/// Layout of raw data
+	uint32_t gl_format = GL_RGBA;
 };
 
+/// @return The number of 8 bit channels of an uncompressed GL format, zero for other formats
+uint32_t get_channel_count(uint32_t gl_format);
+
+/// @return Whether color channels of a GL format are sRGB encoded
+bool is_srgb(uint32_t gl_format);
+
 }        // namespace atk
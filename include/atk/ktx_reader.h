@@ -0,0 +1,87 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "atk/image.h"
+#include "atk/ktx_header.h"
+#include "atk/storage.h"
+
+namespace atk
+{
+/// @brief Reads a KTX file lazily: the file is memory mapped and only its level index
+///        is parsed, images are views of the mapping created on demand
+class KtxReader
+{
+  public:
+	/// @brief Maps a KTX file and parses its level index
+	/// @param[in] path Path of the KTX file
+	KtxReader(const std::string &path);
+
+	/// @return The GL internal format of the texture
+	uint32_t get_gl_format() const;
+
+	uint32_t get_width() const;
+
+	uint32_t get_height() const;
+
+	uint32_t get_depth() const;
+
+	uint32_t get_level_count() const;
+
+	/// @return The number of array layers, one for non array textures
+	uint32_t get_layer_count() const;
+
+	/// @return The number of faces, six for cubemaps
+	uint32_t get_face_count() const;
+
+	/// @param[in] max_size Maximum width and height
+	/// @return The largest level fitting within max_size, or the smallest level if none does
+	uint32_t find_level(uint32_t max_size) const;
+
+	/// @brief Creates an image of a level without reading the others,
+	///        its data stays in the mapping unless rows need to be unpadded
+	/// @param[in] level Mipmap level
+	/// @param[in] layer Array layer
+	/// @param[in] face Cubemap face
+	/// @return A new image, an Astc for astc textures, keeping the file mapped while alive
+	std::unique_ptr<Image> get_image(uint32_t level = 0, uint32_t layer = 0, uint32_t face = 0) const;
+
+  private:
+	std::shared_ptr<Storage> storage;
+
+	KtxHeader header;
+
+	/// Where the first image of each level begins
+	std::vector<size_t> level_offsets;
+
+	/// Size of a single image, either a layer or a face, of each level
+	std::vector<size_t> image_sizes;
+
+	/// Bytes between two images of the same level
+	std::vector<size_t> image_strides;
+};
+
+}        // namespace atk
@@ -0,0 +1,144 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "atk/texture.h"
+
+namespace atk
+{
+/// @brief Writes a KTX file whose layout is computed up front, so images
+///        can be encoded straight into their final place in the output
+class KtxWriter
+{
+  public:
+	/// @brief Computes the layout of a 2D KTX file
+	/// @param[in] gl_format GL internal format of the texture
+	/// @param[in] width Width of the base level
+	/// @param[in] height Height of the base level
+	/// @param[in] level_count Number of mipmap levels
+	/// @param[in] layer_count Number of array layers, a texture of a single layer is not an array
+	/// @param[in] face_count Number of faces, six for cubemaps
+	KtxWriter(uint32_t gl_format, uint32_t width, uint32_t height, uint32_t level_count, uint32_t layer_count = 1,
+	          uint32_t face_count = 1);
+
+	KtxWriter(const KtxWriter &) = delete;
+
+	KtxWriter &operator=(const KtxWriter &) = delete;
+
+	/// @brief Discards the output if it was not closed
+	~KtxWriter();
+
+	/// @brief Prepares the output in a memory buffer
+	void open();
+
+	/// @brief Prepares the output in a memory mapped file, which gets its name only when closed
+	/// @param[in] path Path of the KTX file
+	void open(const std::string &path);
+
+	/// @brief Commits the output, a mapped file is renamed to its final path
+	void close();
+
+	/// @return Where the image of a level, layer and face has to be written
+	uint8_t *get_image_data(uint32_t level, uint32_t layer = 0, uint32_t face = 0);
+
+	/// @return The size in bytes of a single image of a level, rows padding included
+	size_t get_image_size(uint32_t level) const;
+
+	/// @return The number of mipmap levels
+	uint32_t get_level_count() const;
+
+	/// @return The number of array layers
+	uint32_t get_layer_count() const;
+
+	/// @return The number of faces
+	uint32_t get_face_count() const;
+
+	/// @brief Copies an image into a level, padding its rows as KTX requires
+	/// @param[in] level Mipmap level
+	/// @param[in] image Image of the level size in the texture format
+	void set_image(uint32_t level, Image &image);
+
+	/// @brief Copies an image into a level of a layer and face
+	/// @param[in] level Mipmap level
+	/// @param[in] layer Array layer
+	/// @param[in] face Cubemap face
+	/// @param[in] image Image of the level size in the texture format
+	void set_image(uint32_t level, uint32_t layer, uint32_t face, Image &image);
+
+	/// @return The whole KTX data
+	const uint8_t *get_data() const;
+
+	/// @return The size in bytes of the whole KTX data
+	size_t get_size() const;
+
+  private:
+	/// @brief Writes the header and the sizes of the levels
+	void write_layout();
+
+	uint32_t gl_format;
+
+	uint32_t width;
+
+	uint32_t height;
+
+	uint32_t layer_count;
+
+	uint32_t face_count;
+
+	/// Bytes between rows of uncompressed levels, zero for compressed formats
+	std::vector<size_t> row_pitches;
+
+	std::vector<size_t> image_offsets;
+
+	std::vector<size_t> image_sizes;
+
+	/// Bytes between two images of the same level
+	std::vector<size_t> image_strides;
+
+	size_t size = 0;
+
+	/// Output, either a buffer or a mapping
+	uint8_t *data = nullptr;
+
+	std::vector<uint8_t> buffer;
+
+	std::string path;
+
+	std::string temporary_path;
+};
+
+/// @brief Packs a texture into a KTX file, copying its levels as they are
+/// @param[in] texture Texture to pack
+/// @param[in] path Path of the KTX file
+void write_ktx(Texture &texture, const std::string &path);
+
+/// @brief Encodes a texture to astc and packs it into a KTX file, each level of each layer
+///        and face is encoded straight into its place in the file, all in a single parallel schedule
+/// @param[in] texture Texture to encode
+/// @param[in] path Path of the KTX file
+/// @param[in] options Encoder parameters
+void write_astc_ktx(Texture &texture, const std::string &path, const EncodeOptions &options = {});
+
+}        // namespace atk
@@ -20,8 +20,12 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+
 #include <Magick++.h>
 
+#include <atk/buffer_pool.h>
 #include <atk/image.h>
 
 namespace atk
@@ -33,32 +37,46 @@ class MagickImage : public Image
 
 	MagickImage(Magick::Image &&i);
 
-	MagickImage(MagickImage &&image) = default;
+	MagickImage(MagickImage &&other);
 
 	Magick::Image &get_image();
 
 	std::unique_ptr<Image> resize(uint32_t w, uint32_t h) override;
 
+	/// @brief Pixels are exported on first access, in the layout of the GL format
 	const uint8_t *get_data() const override;
 
-	/// @brief Converts image format
+	/// @brief Exports some rows without keeping them, in the layout of the GL format
+	/// @param[in] first_row First row to export
+	/// @param[in] row_count Number of rows to export
+	/// @param[out] rows Room for the rows
+	void export_rows(uint32_t first_row, uint32_t row_count, uint8_t *rows) const;
+
+	/// @brief Selects the layout of the exported pixels, no pass over the image happens here
 	/// @param format Format to apply
 	void convert(Format format) override;
 
 	void store(const std::string &path) override;
 
+	/// @return The GL format matching the color space and the current layout, without side effects
 	uint32_t get_gl_format() override;
 
   private:
 	MagickImage() = default;
 
-	/// @brief Helper function to update raw data stored in blob
-	///        whenever the image changes configuration
-	void update_data();
+	/// @brief Sets the layout of the exported pixels, discarding the pixels exported so far
+	void set_format(Format format);
 
 	Magick::Image image;
 
-	Magick::Blob blob;
+	/// Layout of the exported pixels, either RGB or RGBA
+	Format format = Format::RGBA;
+
+	/// Pixels exported from the image, null until requested
+	mutable std::shared_ptr<PooledStorage> pixels;
+
+	/// Guards the export of pixels
+	mutable std::mutex pixels_mutex;
 };
 
 }        // namespace atk
\ No newline at end of file
@@ -0,0 +1,84 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace atk
+{
+/// @brief Records how each output was built, so outputs whose input, options
+///        and tool version did not change can be skipped by later runs
+class Manifest
+{
+  public:
+	/// @brief How an output was built
+	struct Entry
+	{
+		std::string input;
+
+		/// Hash of the input content
+		std::string input_hash;
+
+		/// Conversion options
+		std::string options;
+
+		/// Version of the tool
+		std::string version;
+	};
+
+	/// @brief Loads a manifest, a missing file gives an empty manifest
+	/// @param[in] path Path of the manifest file
+	Manifest(const std::string &path);
+
+	/// @brief Gives the manifests of a path in use the same instance, so concurrent jobs
+	///        writing the same manifest do not lose each other's entries
+	/// @param[in] path Path of the manifest file
+	/// @return The manifest in use for this path, or a newly loaded one
+	static std::shared_ptr<Manifest> get_shared(const std::string &path);
+
+	/// @return The hash of the content of a file
+	static std::string hash_file(const std::string &path);
+
+	/// @param[in] output Path of the output
+	/// @param[in] entry How the output would be built
+	/// @return Whether the output exists and was built the same way
+	bool is_up_to_date(const std::string &output, const Entry &entry) const;
+
+	/// @brief Records how an output was built
+	void set(const std::string &output, const Entry &entry);
+
+	/// @brief Writes the manifest, replacing the previous file in one step. Saves are
+	///        serialized, so the last file written holds every entry set before it
+	void save() const;
+
+  private:
+	std::string path;
+
+	/// Entries by output path
+	std::map<std::string, Entry> entries;
+
+	mutable std::mutex entries_mutex;
+};
+
+}        // namespace atk
@@ -0,0 +1,91 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "atk/image.h"
+
+namespace atk
+{
+/// @brief What to measure besides the error of each channel
+struct MetricsOptions
+{
+	/// Whether to compute the structural similarity
+	bool ssim = true;
+
+	/// Width of the blocks whose error is measured, zero to skip them
+	uint32_t block_width = 0;
+
+	/// Height of the blocks whose error is measured, zero to skip them
+	uint32_t block_height = 0;
+};
+
+/// @brief Error of an image against a reference, for each channel
+struct Metrics
+{
+	uint32_t channel_count = 0;
+
+	/// Mean squared error
+	double mse[4] = {};
+
+	/// Peak signal to noise ratio in dB, infinite when there is no error
+	double psnr[4] = {};
+
+	/// Largest absolute difference of a texel
+	uint8_t max_error[4] = {};
+
+	/// Mean structural similarity over 8x8 windows, one when the images are the same, zero when not measured
+	double ssim[4] = {};
+
+	/// Number of blocks along each dimension, when blocks were measured
+	uint32_t block_columns = 0;
+
+	uint32_t block_rows = 0;
+
+	/// Mean squared error of every channel of each block, row by row
+	std::vector<double> block_mse;
+
+	/// @return The mean squared error over every channel
+	double get_mse() const;
+
+	/// @return The peak signal to noise ratio over every channel
+	double get_psnr() const;
+
+	/// @return The structural similarity averaged over every channel
+	double get_ssim() const;
+
+	/// @return The largest absolute difference of any channel
+	uint8_t get_max_error() const;
+};
+
+/// @brief Measures the error of an image in one parallel pass over both images
+/// @param[in] reference Original image, 8 bit RGB or RGBA
+/// @param[in] image Image to measure, same size and channels as the reference
+/// @param[in] options What to measure besides the error of each channel
+/// @return The error of each channel
+Metrics measure(const Image &reference, const Image &image, const MetricsOptions &options = {});
+
+/// @return The peak signal to noise ratio in dB of a mean squared error of 8 bit values
+double get_psnr(double mse);
+
+}        // namespace atk
@@ -0,0 +1,98 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "atk/image.h"
+
+namespace atk
+{
+/// @brief Downsamples the rows of an 8 bit RGB or RGBA image one at a time, so the next
+///        level can be computed while the rows of the image are still arriving
+class MipmapFilter
+{
+  public:
+	struct TransferTables;
+
+	/// @param[in] width Width of the source level
+	/// @param[in] height Height of the source level
+	/// @param[in] gl_format Format of the source level
+	MipmapFilter(uint32_t width, uint32_t height, uint32_t gl_format);
+
+	uint32_t get_dst_width() const;
+
+	uint32_t get_dst_height() const;
+
+	/// @return The first source row contributing to a destination row
+	uint32_t get_first_row(uint32_t dst_row) const;
+
+	/// @return The number of source rows contributing to a destination row
+	uint32_t get_row_count(uint32_t dst_row) const;
+
+	/// @brief Computes a row of the next level
+	/// @param[in] dst_row Index of the destination row
+	/// @param[in] src Source rows, starting from the first contributing one
+	/// @param[out] dst Destination row
+	/// @param scratch Working memory, better reused between calls of the same thread
+	void filter_row(uint32_t dst_row, const uint8_t *src, uint8_t *dst, std::vector<float> &scratch) const;
+
+  private:
+	/// @brief Source texels contributing to a destination texel along one dimension
+	struct Taps
+	{
+		uint32_t first = 0;
+
+		uint32_t count = 0;
+
+		float weights[3] = {};
+	};
+
+	/// @param[in] dst Destination coordinate
+	/// @param[in] src_size Source size along the same dimension
+	/// @return The taps for a destination coordinate
+	static Taps get_taps(uint32_t dst, uint32_t src_size);
+
+	uint32_t channels;
+
+	uint32_t src_width;
+
+	uint32_t src_height;
+
+	uint32_t dst_width;
+
+	uint32_t dst_height;
+
+	/// Transfer tables of each channel
+	const TransferTables *tables[4] = {};
+
+	std::vector<Taps> column_taps;
+};
+
+/// @brief Downsamples an 8 bit RGB or RGBA image to the next level of its mipmap chain.
+///        Color channels of sRGB images are filtered in linear space. Odd dimensions use
+///        a three taps filter, so every texel of the source contributes to the result
+/// @param[in] image Level to downsample
+/// @return The next level, half the size of the passed one rounding down
+std::unique_ptr<Image> generate_mipmap(Image &image);
+
+}        // namespace atk
@@ -0,0 +1,184 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace atk
+{
+/// @brief Answer of a server job
+struct ServerResponse
+{
+	/// Whether the job succeeded
+	bool ok = true;
+
+	/// Members of the JSON object answering the request, without braces
+	std::string fields;
+
+	/// Files whose bytes are sent after the answer
+	std::vector<std::string> files;
+};
+
+/// @brief Keeps the process and its thread pool alive between jobs, so each job
+///        only pays for its own work. Requests are lines of arguments, each one
+///        answered by a line of JSON, optionally followed by the bytes of files
+class Server
+{
+  public:
+	/// @brief Runs a job, it is called by several workers at once
+	using Handler = std::function<ServerResponse(const std::vector<std::string> &args)>;
+
+	/// @brief Counters of the jobs served
+	struct Stats
+	{
+		/// Jobs waiting for a worker
+		size_t queue_depth = 0;
+
+		/// Jobs being run by a worker
+		size_t running_count = 0;
+
+		uint64_t completed_count = 0;
+
+		uint64_t failed_count = 0;
+
+		/// Seconds since the server started
+		double uptime_s = 0.0;
+
+		/// Completed jobs per second since the server started
+		double jobs_per_s = 0.0;
+
+		/// Percentiles of the time from request to answer of the latest jobs
+		double latency_p50_s = 0.0;
+		double latency_p95_s = 0.0;
+		double latency_p99_s = 0.0;
+	};
+
+	/// @param[in] handler Runs each job
+	/// @param[in] worker_count Jobs run at once, each one using the thread pool
+	Server(Handler handler, uint32_t worker_count = 2);
+
+	Server(const Server &) = delete;
+
+	Server &operator=(const Server &) = delete;
+
+	/// @brief Finishes the jobs already queued and stops the workers
+	~Server();
+
+	/// @brief Answers the requests of a stream, one at a time, until it ends or asks to quit
+	/// @param[in] is Stream of requests
+	/// @param[out] os Stream of answers
+	void serve(std::istream &is, std::ostream &os);
+
+	/// @brief Accepts clients on a Unix domain socket, each one served by its own thread,
+	///        until a client asks for a shutdown. The other clients then get the answers
+	///        of the requests they already sent before they are disconnected
+	/// @param[in] socket_path Path of the socket, replaced if it exists
+	void listen(const std::string &socket_path);
+
+	/// @brief Queues a job
+	/// @param[in] args Arguments of the job
+	/// @return The answer line of the job, followed by the bytes of its files
+	std::future<std::string> submit(const std::vector<std::string> &args);
+
+	Stats get_stats() const;
+
+	/// @return The counters as a JSON object
+	std::string get_stats_json() const;
+
+	/// @brief Splits a request line into arguments, double quotes group spaces
+	static std::vector<std::string> split_args(const std::string &line);
+
+  private:
+	struct Job
+	{
+		uint64_t id = 0;
+
+		std::vector<std::string> args;
+
+		std::chrono::steady_clock::time_point submit_time;
+
+		std::promise<std::string> answer;
+	};
+
+	/// @brief Worker loop, runs jobs until the server stops
+	void work();
+
+	/// @brief Answers a request line
+	/// @param[out] quit Set when the client asks to quit
+	/// @param[out] shutdown Set when the client asks the server to stop
+	/// @return The answer, empty for blank lines
+	std::string handle_line(const std::string &line, bool &quit, bool &shutdown);
+
+	/// @brief Serves a client connected to the socket
+	void serve_client(int client);
+
+	/// @brief Stops accepting clients and requests, the connected clients are disconnected
+	///        once their requests are answered
+	void stop_listening();
+
+	Handler handler;
+
+	std::chrono::steady_clock::time_point start_time;
+
+	uint64_t next_id = 0;
+
+	std::deque<Job> jobs;
+
+	size_t running_count = 0;
+
+	uint64_t completed_count = 0;
+
+	uint64_t failed_count = 0;
+
+	/// Latencies of the latest jobs, as a ring
+	std::vector<double> latencies;
+
+	size_t next_latency = 0;
+
+	bool stopping = false;
+
+	mutable std::mutex mutex;
+
+	std::condition_variable condition;
+
+	std::vector<std::thread> workers;
+
+	/// Socket accepting clients, negative when not listening
+	std::atomic<int> listener{-1};
+
+	/// Sockets of the connected clients
+	std::set<int> clients;
+};
+
+}        // namespace atk
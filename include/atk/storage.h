@@ -0,0 +1,101 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace atk
+{
+/// @brief Memory backing the data of an image
+class Storage
+{
+  public:
+	virtual ~Storage() = default;
+
+	/// @return The beginning of the memory
+	virtual const uint8_t *get_data() const = 0;
+
+	/// @return The size of the memory in bytes
+	virtual size_t get_size() const = 0;
+};
+
+/// @brief Memory allocated with new[] and owned by the storage
+class HeapStorage : public Storage
+{
+  public:
+	/// @param[in] d Memory allocated with new[], the storage takes ownership
+	/// @param[in] s Size of the memory in bytes
+	HeapStorage(uint8_t *d, size_t s);
+
+	~HeapStorage() override;
+
+	const uint8_t *get_data() const override;
+
+	size_t get_size() const override;
+
+  private:
+	uint8_t *data = nullptr;
+
+	size_t size = 0;
+};
+
+/// @brief Memory owned by somebody else, who keeps it alive as long as the view
+class ViewStorage : public Storage
+{
+  public:
+	ViewStorage(const uint8_t *d, size_t s);
+
+	const uint8_t *get_data() const override;
+
+	size_t get_size() const override;
+
+  private:
+	const uint8_t *data = nullptr;
+
+	size_t size = 0;
+};
+
+/// @brief Read-only memory mapping of a whole file, pages are loaded on access
+class MappedStorage : public Storage
+{
+  public:
+	/// @param[in] path Path of the file to map
+	MappedStorage(const std::string &path);
+
+	MappedStorage(const MappedStorage &) = delete;
+
+	MappedStorage &operator=(const MappedStorage &) = delete;
+
+	~MappedStorage() override;
+
+	const uint8_t *get_data() const override;
+
+	size_t get_size() const override;
+
+  private:
+	uint8_t *data = nullptr;
+
+	size_t size = 0;
+};
+
+}        // namespace atk
@@ -0,0 +1,123 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "atk/astc.h"
+#include "atk/ktx_writer.h"
+#include "atk/magick.h"
+#include "atk/mipmap.h"
+
+namespace atk
+{
+/// @brief Encodes the rows of an image to astc as they arrive, together with its mipmaps.
+///        Each level keeps only the rows of its next strip and those needed by the next level,
+///        so memory is bounded by the size of a strip rather than by the size of the image
+class StripEncoder
+{
+  public:
+	/// @param[in] writer Output with the astc format of the options, whose levels are encoded
+	/// @param[in] width Width of the image
+	/// @param[in] height Height of the image
+	/// @param[in] gl_format RGBA8 format of the rows, sRGB or linear
+	/// @param[in] options Encoder parameters
+	/// @param[in] strip_block_rows Block rows encoded together
+	StripEncoder(KtxWriter &writer, uint32_t width, uint32_t height, uint32_t gl_format, const EncodeOptions &options, uint32_t strip_block_rows = 4);
+
+	/// @brief Encodes the rows which complete a strip, in any level
+	/// @param[in] rows RGBA8 rows following the ones already pushed
+	/// @param[in] row_count Number of rows
+	void push_rows(const uint8_t *rows, uint32_t row_count);
+
+	/// @return Whether every row of every level has been encoded
+	bool is_complete() const;
+
+	/// @return The largest number of rows a level kept at once
+	uint32_t get_peak_row_count() const;
+
+  private:
+	struct Level
+	{
+		uint32_t width = 0;
+
+		uint32_t height = 0;
+
+		/// RGBA8 rows kept, starting from first_row
+		std::vector<uint8_t> rows;
+
+		uint32_t first_row = 0;
+
+		/// Rows received so far
+		uint32_t row_count = 0;
+
+		uint32_t encoded_row_count = 0;
+
+		/// Rows of the next level computed so far
+		uint32_t filtered_row_count = 0;
+
+		/// Filter computing the next level, null for the last one
+		std::unique_ptr<MipmapFilter> filter;
+	};
+
+	/// @brief Appends rows to a level
+	void append(Level &level, const uint8_t *rows, uint32_t row_count);
+
+	/// @brief Computes the rows of the next levels which can be computed
+	void filter_levels();
+
+	/// @brief Encodes the strips which are complete in a single parallel schedule
+	void encode_strips();
+
+	/// @brief Drops the rows which are no longer needed
+	void drop_rows();
+
+	KtxWriter &writer;
+
+	uint32_t gl_format;
+
+	EncodeOptions options;
+
+	/// Rows of a strip, a multiple of the block height
+	uint32_t strip_row_count;
+
+	std::vector<Level> levels;
+
+	uint32_t peak_row_count = 0;
+};
+
+/// @return The number of levels of a full mipmap chain
+uint32_t get_mipmap_level_count(uint32_t width, uint32_t height);
+
+/// @brief Encodes an image to astc strip by strip and packs it into a KTX file. Rows
+///        are exported from the image a strip at a time, and mipmaps are filtered
+///        from the rows of the previous level as they arrive
+/// @param[in] image Image to encode
+/// @param[in] path Path of the KTX file
+/// @param[in] mipmaps Whether to generate the mipmap chain
+/// @param[in] options Encoder parameters
+/// @param[in] strip_block_rows Block rows encoded together
+void write_astc_ktx_strips(MagickImage &image, const std::string &path, bool mipmaps, const EncodeOptions &options = {}, uint32_t strip_block_rows = 4);
+
+}        // namespace atk
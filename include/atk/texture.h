@@ -25,51 +25,92 @@
 
 #include <Magick++.h>
 
+#include "atk/astc.h"
 #include "atk/image.h"
 
 namespace atk
 {
+/// @brief Ways of generating a mipmap chain
+enum class MipmapGenerator
+{
+	/// Each level is filtered from the previous one
+	Native,
+	/// Each level is resized from the image by ImageMagick
+	Magick
+};
+
+/// @brief Image with its mipmap chain, or several of them for array layers and cubemap faces
 class Texture
 {
   public:
 	/// @brief Creates a texture containing a Magick Image
 	Texture(std::unique_ptr<Image> &&i);
 
+	/// @brief Creates a texture from the base images of its layers and faces, which have the same size
+	/// @param[in] images Images of each layer in turn, the faces of a layer being consecutive
+	/// @param[in] layer_count Number of array layers, a texture of a single layer is not an array
+	/// @param[in] face_count Number of faces, six for cubemaps in the +X, -X, +Y, -Y, +Z, -Z order
+	Texture(std::vector<std::unique_ptr<Image>> &&images, uint32_t layer_count, uint32_t face_count = 1);
+
+	/// @return The base image of the first layer and face
 	Image &get_image();
 
-	/// @brief Generates the mipmap chain for the image
-	void generate_mipmap_chain();
+	/// @return The image of a mipmap level of a layer and face
+	Image &get_level(uint32_t level, uint32_t layer = 0, uint32_t face = 0);
 
-	/// @brief Converts the image and its mipmaps
+	/// @brief Generates the mipmap chain of every layer and face
+	/// @param[in] generator How to generate the levels
+	void generate_mipmap_chain(MipmapGenerator generator = MipmapGenerator::Native);
+
+	/// @brief Converts the images and their mipmaps
 	/// @param[in] format Conversion format
-	void convert(const Format format);
+	/// @param[in] options Encoder parameters for compressed formats
+	void convert(const Format format, const EncodeOptions &options = {});
 
 	/// @return The number of mipmap levels
 	size_t get_levels() const
 	{
-		return mipmap_chain.size() + 1;
+		return mipmap_chains.front().size() + 1;
 	}
 
-	/// @return The mipmap chain vector
-	std::vector<std::unique_ptr<Image>> &get_mipmap_chain()
+	/// @return The number of array layers
+	uint32_t get_layer_count() const
 	{
-		return mipmap_chain;
+		return layer_count;
+	}
+
+	/// @return The number of faces, six for cubemaps
+	uint32_t get_face_count() const
+	{
+		return face_count;
+	}
+
+	/// @return The mipmap chain vector of a layer and face
+	std::vector<std::unique_ptr<Image>> &get_mipmap_chain(uint32_t layer = 0, uint32_t face = 0)
+	{
+		return mipmap_chains.at(layer * face_count + face);
 	}
 
 	const Image &operator*() const
 	{
-		return *image;
+		return *images.front();
 	}
 
 	const Image *operator->() const
 	{
-		return image.get();
+		return images.front().get();
 	}
 
   private:
-	std::unique_ptr<Image> image = nullptr;
+	/// Base image of each layer and face
+	std::vector<std::unique_ptr<Image>> images;
+
+	/// Mipmap chain of each layer and face, in the same order as the images
+	std::vector<std::vector<std::unique_ptr<Image>>> mipmap_chains;
+
+	uint32_t layer_count = 1;
 
-	std::vector<std::unique_ptr<Image>> mipmap_chain;
+	uint32_t face_count = 1;
 };
 
 }        // namespace atk
@@ -0,0 +1,87 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace atk
+{
+/// @return The number of cores this process is allowed to run on,
+///         according to its CPU affinity mask when the platform has one
+uint32_t get_available_thread_count();
+
+/// @brief Pool of persistent worker threads shared by the library
+class ThreadPool
+{
+  public:
+	/// @brief Starts the worker threads
+	/// @param[in] thread_count Number of threads taking part in the work, calling thread included.
+	///                         Zero means one thread for each available core
+	ThreadPool(uint32_t thread_count = 0);
+
+	ThreadPool(const ThreadPool &) = delete;
+
+	ThreadPool &operator=(const ThreadPool &) = delete;
+
+	/// @brief Waits for pending tasks and joins the workers
+	~ThreadPool();
+
+	/// @return The number of threads taking part in the work, calling thread included
+	uint32_t get_thread_count() const;
+
+	/// @brief Calls a function for every index in [0, count) spreading the calls on the pool.
+	///        The calling thread takes part in the work, so this can be nested in a task.
+	///        If any call throws, remaining indices are skipped and the first exception is rethrown
+	/// @param[in] count Number of indices
+	/// @param[in] func Function to call with each index
+	void parallel_for(size_t count, const std::function<void(size_t)> &func);
+
+	/// @return The pool used by the library
+	static ThreadPool &get_default();
+
+	/// @brief Sets the number of threads of the pool used by the library, before its first use.
+	///        The pool is never replaced, so references to it stay valid
+	/// @param[in] thread_count Number of threads, zero to detect it
+	/// @throw std::logic_error if the pool is already running
+	static void set_default_thread_count(uint32_t thread_count);
+
+  private:
+	/// @brief Worker loop, runs tasks until the pool is stopped
+	void work();
+
+	std::vector<std::thread> workers;
+
+	std::deque<std::function<void()>> tasks;
+
+	std::mutex mutex;
+
+	std::condition_variable condition;
+
+	bool stopping = false;
+};
+
+}        // namespace atk
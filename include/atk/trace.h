@@ -0,0 +1,149 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace atk
+{
+/// @brief Stage of a conversion recorded by the tracer
+struct TraceEvent
+{
+	/// Name of the stage, a string literal
+	const char *name = nullptr;
+
+	/// Input file being converted, empty when the stage is not tied to one
+	std::string file;
+
+	/// Mipmap level, negative when the stage is not tied to one
+	int32_t level = -1;
+
+	/// Small number identifying the thread which ran the stage
+	uint32_t thread_id = 0;
+
+	/// Start since the tracer started
+	uint64_t start_ns = 0;
+
+	uint64_t wall_ns = 0;
+
+	/// Time the thread ran on a CPU, without the work it handed to other threads
+	uint64_t cpu_ns = 0;
+
+	/// Bytes processed by the stage
+	uint64_t bytes = 0;
+
+	/// Peak resident memory of the process at the end of the stage
+	uint64_t peak_rss = 0;
+};
+
+/// @brief Collects trace events from every thread, nothing is recorded until it starts
+class Tracer
+{
+  public:
+	/// @brief Starts recording events, it can not be stopped
+	static void start();
+
+	/// @return The tracer, null when it was not started
+	static Tracer *get()
+	{
+		return instance.load(std::memory_order_acquire);
+	}
+
+	/// @return The time since the tracer started
+	uint64_t get_time_ns() const;
+
+	void record(TraceEvent &&event);
+
+	/// @return A copy of the events recorded so far
+	std::vector<TraceEvent> get_events() const;
+
+	/// @brief Writes the events in the Chrome trace event format, which
+	///        can be opened with chrome://tracing or the Perfetto UI
+	/// @param[in] path Path of the trace file
+	void write_chrome_trace(const std::string &path) const;
+
+	/// @brief Writes the totals of each stage, and every stage of each file, as JSON
+	void write_stats(std::ostream &os) const;
+
+  private:
+	Tracer();
+
+	static std::atomic<Tracer *> instance;
+
+	std::chrono::steady_clock::time_point start_time;
+
+	mutable std::mutex mutex;
+
+	std::vector<TraceEvent> events;
+};
+
+/// @brief Records a stage from its construction to its destruction,
+///        when the tracer was not started it only checks whether it was
+class TraceScope
+{
+  public:
+	/// @param[in] name Name of the stage, a string literal
+	/// @param[in] level Mipmap level, negative when the stage is not tied to one
+	/// @param[in] bytes Bytes processed by the stage
+	TraceScope(const char *name, int32_t level = -1, uint64_t bytes = 0);
+
+	TraceScope(const TraceScope &) = delete;
+
+	TraceScope &operator=(const TraceScope &) = delete;
+
+	~TraceScope();
+
+	void set_bytes(uint64_t bytes);
+
+  private:
+	Tracer *tracer = nullptr;
+
+	TraceEvent event;
+
+	uint64_t start_cpu_ns = 0;
+};
+
+/// @brief Ties the stages recorded by the calling thread to a file while it lives
+class TraceFile
+{
+  public:
+	/// @param[in] path Path of the input file
+	TraceFile(const std::string &path);
+
+	TraceFile(const TraceFile &) = delete;
+
+	TraceFile &operator=(const TraceFile &) = delete;
+
+	~TraceFile();
+
+  private:
+	bool enabled = false;
+
+	std::string previous;
+};
+
+}        // namespace atk
@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace atk
@@ -30,4 +32,27 @@ std::string get_basename_no_extension(const std::string &file_path);
 /// @return The extension of a file
 std::string get_extension(const std::string &file_path);
 
+/// @return A temporary path next to a file, unique to this process and call,
+///        so a file can be written aside and renamed to its path in one step
+std::string get_temporary_path(const std::string &path);
+
+/// @brief Fast non cryptographic hash (MurmurHash64A)
+/// @param[in] data Data to hash
+/// @param[in] size Size of data in bytes
+/// @param[in] seed Seed, which can be the hash of previous data
+/// @return The 64 bit hash of the data
+uint64_t get_hash(const void *data, size_t size, uint64_t seed = 0);
+
+/// @return A value as 16 hexadecimal digits
+std::string to_hex(uint64_t value);
+
+/// @return The version of ktx-creator
+const char *get_version();
+
+/// @return A string as a JSON string literal, quotes included
+std::string quote_json(const std::string &str);
+
+/// @return The peak resident memory of the process in bytes, zero when unknown
+uint64_t get_peak_rss();
+
 }        // namespace atk
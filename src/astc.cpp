@@ -20,21 +20,168 @@
 #include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <sys/stat.h>
+#include <unordered_set>
 
 #include "atk/astc.h"
+#include "atk/buffer_pool.h"
+#include "atk/thread_pool.h"
 
 namespace atk
 {
-Astc::~Astc()
+void prepare_astc_tables(const BlockDim block_dim)
 {
-	if (codec_image)
+	if (get_astc_gl_format(block_dim) == 0)
 	{
-		destroy_image(codec_image);
+		throw std::runtime_error{"Invalid astc block footprint"};
 	}
+
+	static std::once_flag               shared_tables;
+	static std::mutex                   mutex;
+	static std::unordered_set<uint32_t> footprints;
+
+	// Angular and quantization tables are the same for every footprint
+	std::call_once(shared_tables, [] {
+		prepare_angular_tables();
+		build_quantization_mode_table();
+	});
+
+	std::lock_guard<std::mutex> lock{mutex};
+	if (!footprints.emplace(block_dim.x | block_dim.y << 8 | block_dim.z << 16).second)
+	{
+		return;
+	}
+
+	// The codec builds these on first use, which is not safe from files encoded concurrently
+	get_block_size_descriptor(block_dim.x, block_dim.y, block_dim.z);
+	for (int partition_count = 1; partition_count <= 4; ++partition_count)
+	{
+		get_partition_table(block_dim.x, block_dim.y, block_dim.z, partition_count);
+	}
+}
+
+/// @return A normalized channel value converted to 8 bits
+inline uint8_t to_unorm8(float value)
+{
+	value = std::min(std::max(value, 0.0f), 1.0f);
+	return static_cast<uint8_t>(value * 255.0f + 0.5f);
+}
+
+/// @brief Astc GL format and its block dimensions
+struct AstcFormat
+{
+	uint32_t gl_format;
+	BlockDim block_dim;
+};
+
+const AstcFormat astc_formats[] = {
+    {GL_COMPRESSED_RGBA_ASTC_4x4_KHR, {4, 4, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_5x4_KHR, {5, 4, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_5x5_KHR, {5, 5, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_6x5_KHR, {6, 5, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_6x6_KHR, {6, 6, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_8x5_KHR, {8, 5, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_8x6_KHR, {8, 6, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_8x8_KHR, {8, 8, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_10x5_KHR, {10, 5, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_10x6_KHR, {10, 6, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_10x8_KHR, {10, 8, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_10x10_KHR, {10, 10, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_12x10_KHR, {12, 10, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_12x12_KHR, {12, 12, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR, {4, 4, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR, {5, 4, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR, {5, 5, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR, {6, 5, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR, {6, 6, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR, {8, 5, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR, {8, 6, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR, {8, 8, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR, {10, 5, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR, {10, 6, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR, {10, 8, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR, {10, 10, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR, {12, 10, 1}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR, {12, 12, 1}},
+    {GL_COMPRESSED_RGBA_ASTC_3x3x3_OES, {3, 3, 3}},
+    {GL_COMPRESSED_RGBA_ASTC_4x3x3_OES, {4, 3, 3}},
+    {GL_COMPRESSED_RGBA_ASTC_4x4x3_OES, {4, 4, 3}},
+    {GL_COMPRESSED_RGBA_ASTC_4x4x4_OES, {4, 4, 4}},
+    {GL_COMPRESSED_RGBA_ASTC_5x4x4_OES, {5, 4, 4}},
+    {GL_COMPRESSED_RGBA_ASTC_5x5x4_OES, {5, 5, 4}},
+    {GL_COMPRESSED_RGBA_ASTC_5x5x5_OES, {5, 5, 5}},
+    {GL_COMPRESSED_RGBA_ASTC_6x5x5_OES, {6, 5, 5}},
+    {GL_COMPRESSED_RGBA_ASTC_6x6x5_OES, {6, 6, 5}},
+    {GL_COMPRESSED_RGBA_ASTC_6x6x6_OES, {6, 6, 6}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_3x3x3_OES, {3, 3, 3}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x3x3_OES, {4, 3, 3}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4x3_OES, {4, 4, 3}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4x4_OES, {4, 4, 4}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4x4_OES, {5, 4, 4}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5x4_OES, {5, 5, 4}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5x5_OES, {5, 5, 5}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5x5_OES, {6, 5, 5}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6x5_OES, {6, 6, 5}},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6x6_OES, {6, 6, 6}},
+};
+
+BlockDim get_block_dim(const uint32_t gl_format)
+{
+	for (auto &format : astc_formats)
+	{
+		if (format.gl_format == gl_format)
+		{
+			return format.block_dim;
+		}
+	}
+
+	return {};
+}
+
+uint32_t get_astc_gl_format(const BlockDim block_dim, const bool srgb)
+{
+	for (auto &format : astc_formats)
+	{
+		if (format.block_dim.x == block_dim.x && format.block_dim.y == block_dim.y && format.block_dim.z == block_dim.z &&
+		    is_srgb(format.gl_format) == srgb)
+		{
+			return format.gl_format;
+		}
+	}
+
+	return 0;
+}
+
+BlockDim parse_block_dim(const std::string &footprint)
+{
+	unsigned x = 0, y = 0, z = 1;
+	char     end = 0;
+
+	// Either three dimensions or two, without anything after them
+	bool valid = std::sscanf(footprint.c_str(), "%ux%ux%u%c", &x, &y, &z, &end) == 3;
+	if (!valid)
+	{
+		z     = 1;
+		valid = std::sscanf(footprint.c_str(), "%ux%u%c", &x, &y, &end) == 2;
+	}
+
+	if (valid && x < 256 && y < 256 && z < 256)
+	{
+		BlockDim block_dim{uint8_t(x), uint8_t(y), uint8_t(z)};
+		if (get_astc_gl_format(block_dim) != 0)
+		{
+			return block_dim;
+		}
+	}
+
+	throw std::runtime_error{"Invalid astc block footprint [" + footprint + "]"};
 }
 
 Astc::Astc(Astc &&other) :
@@ -43,130 +190,153 @@ Astc::Astc(Astc &&other) :
     swizzle{other.swizzle},
     block_dim{other.block_dim},
     ewp{other.ewp},
-    codec_image{other.codec_image}
+    source{other.source},
+    extent{other.extent},
+    blocks{other.blocks}
 {
-	other.codec_image = nullptr;
+	other.source = {};
+	other.blocks = nullptr;
 }
 
-Astc::Astc(const uint8_t *data)
+/// Magic number of astc files
+const uint32_t MAGIC_FILE_CONSTANT = 0x5CA1AB13;
+
+void Astc::set_header(const AstcHeader &hdr)
 {
-	// Get the header
-	auto astc_data = reinterpret_cast<const AstcHeader *>(data);
+	auto magic = hdr.magic[0] + (hdr.magic[1] << 8) + (hdr.magic[2] << 16) + (uint32_t(hdr.magic[3]) << 24);
+	if (magic != MAGIC_FILE_CONSTANT)
+	{
+		throw std::runtime_error{"Error reading astc: invalid magic number"};
+	}
+
+	block_dim = hdr.blockdim;
+	if (block_dim.x == 0 || block_dim.y == 0 || block_dim.z == 0)
+	{
+		throw std::runtime_error{"Error reading astc: invalid block dimensions"};
+	}
 
 	// Merge x,y,z-sizes from 3 chars into one integer value
-	auto width  = astc_data->xsize[0] + (astc_data->xsize[1] << 8) + (astc_data->xsize[2] << 16);
-	auto height = astc_data->ysize[0] + (astc_data->ysize[1] << 8) + (astc_data->ysize[2] << 16);
-	auto depth  = astc_data->zsize[0] + (astc_data->zsize[1] << 8) + (astc_data->zsize[2] << 16);
+	set_width(hdr.xsize[0] + (hdr.xsize[1] << 8) + (hdr.xsize[2] << 16));
+	set_height(hdr.ysize[0] + (hdr.ysize[1] << 8) + (hdr.ysize[2] << 16));
+	set_depth(hdr.zsize[0] + (hdr.zsize[1] << 8) + (hdr.zsize[2] << 16));
 
-	block_dim = astc_data->blockdim;
+	// Each block is encoded on 16 bytes, so calculate total compressed image data size
+	set_size(get_block_count() << 4);
+}
 
-	set_width(width);
-	set_height(height);
-	set_depth(depth);
+AstcHeader Astc::get_header() const
+{
+	AstcHeader hdr;
+
+	hdr.magic[0]   = MAGIC_FILE_CONSTANT & 0xFF;
+	hdr.magic[1]   = (MAGIC_FILE_CONSTANT >> 8) & 0xFF;
+	hdr.magic[2]   = (MAGIC_FILE_CONSTANT >> 16) & 0xFF;
+	hdr.magic[3]   = (MAGIC_FILE_CONSTANT >> 24) & 0xFF;
+	hdr.blockdim.x = block_dim.x;
+	hdr.blockdim.y = block_dim.y;
+	hdr.blockdim.z = block_dim.z;
+	hdr.xsize[0]   = get_width() & 0xFF;
+	hdr.xsize[1]   = (get_width() >> 8) & 0xFF;
+	hdr.xsize[2]   = (get_width() >> 16) & 0xFF;
+	hdr.ysize[0]   = get_height() & 0xFF;
+	hdr.ysize[1]   = (get_height() >> 8) & 0xFF;
+	hdr.ysize[2]   = (get_height() >> 16) & 0xFF;
+	hdr.zsize[0]   = get_depth() & 0xFF;
+	hdr.zsize[1]   = (get_depth() >> 8) & 0xFF;
+	hdr.zsize[2]   = (get_depth() >> 16) & 0xFF;
+
+	return hdr;
+}
 
-	// Each block is encoded on 16 bytes, so calculate total compressed image data size
-	auto size = get_xblocks() * get_yblocks() * get_zblocks() << 4;
-	set_size(size);
+Astc::Astc(const uint8_t *data)
+{
+	set_header(*reinterpret_cast<const AstcHeader *>(data));
+
+	// Take ownership of the data, blocks follow the header
+	auto storage = std::make_shared<HeapStorage>(const_cast<uint8_t *>(data), sizeof(AstcHeader) + get_size());
+	set_storage(storage, sizeof(AstcHeader));
+}
+
+void Astc::set_gl_format(const uint32_t gl_format)
+{
+	block_dim = atk::get_block_dim(gl_format);
+	if (block_dim.x == 0)
+	{
+		throw std::runtime_error{"Not an astc format"};
+	}
+
+	decode_mode = is_srgb(gl_format) ? DECODE_LDR_SRGB : DECODE_LDR;
+}
 
-	set_memory(data);
+uint32_t Astc::get_gl_format()
+{
+	return get_astc_gl_format(block_dim, decode_mode == DECODE_LDR_SRGB);
 }
 
-Astc::Astc(uint32_t width, uint32_t height, uint32_t depth, const uint8_t *mem)
+Astc::Astc(uint32_t width, uint32_t height, uint32_t depth, const uint8_t *mem, const uint32_t gl_format)
 {
+	set_gl_format(gl_format);
+
 	set_width(width);
 	set_height(height);
 	set_depth(depth);
 
-	auto size = get_xblocks() * get_yblocks() * get_zblocks() << 4;
+	auto size = get_block_count() << 4;
 	set_size(size);
 
-	auto        data = new uint8_t[sizeof(AstcHeader) + size];
-	set_memory(data);
-
-	AstcHeader &hdr  = *reinterpret_cast<AstcHeader *>(data);
-
-	const uint32_t MAGIC_FILE_CONSTANT = 0x5CA1AB13;
-	hdr.magic[0]                       = MAGIC_FILE_CONSTANT & 0xFF;
-	hdr.magic[1]                       = (MAGIC_FILE_CONSTANT >> 8) & 0xFF;
-	hdr.magic[2]                       = (MAGIC_FILE_CONSTANT >> 16) & 0xFF;
-	hdr.magic[3]                       = (MAGIC_FILE_CONSTANT >> 24) & 0xFF;
-	hdr.blockdim.x                     = block_dim.x;
-	hdr.blockdim.y                     = block_dim.y;
-	hdr.blockdim.z                     = block_dim.z;
-	hdr.xsize[0]                       = get_width() & 0xFF;
-	hdr.xsize[1]                       = (get_width() >> 8) & 0xFF;
-	hdr.xsize[2]                       = (get_width() >> 16) & 0xFF;
-	hdr.ysize[0]                       = get_height() & 0xFF;
-	hdr.ysize[1]                       = (get_height() >> 8) & 0xFF;
-	hdr.ysize[2]                       = (get_height() >> 16) & 0xFF;
-	hdr.zsize[0]                       = get_depth() & 0xFF;
-	hdr.zsize[1]                       = (get_depth() >> 8) & 0xFF;
-	hdr.zsize[2]                       = (get_depth() >> 16) & 0xFF;
-
-	std::copy(mem, mem + size, data + sizeof(AstcHeader));
+	auto storage = BufferPool::get_default().allocate(size);
+	std::copy(mem, mem + size, storage->get_buffer());
+	set_storage(std::move(storage));
 }
 
-Astc::Astc(const std::string &file_path)
+Astc::Astc(std::shared_ptr<Storage> storage, const size_t offset, const uint32_t width, const uint32_t height, const uint32_t depth, const uint32_t gl_format)
 {
-	size_t result    = 0;
-	auto   file_name = file_path.c_str();
+	set_gl_format(gl_format);
 
-	FILE *compressed_data_file = fopen(file_name, "rb");
+	set_width(width);
+	set_height(height);
+	set_depth(depth);
+	set_size(get_block_count() << 4);
 
-	if (compressed_data_file == NULL)
+	if (offset + get_size() > storage->get_size())
 	{
-		std::cerr << "Could not open [" << file_name << "]\n";
-		exit(EXIT_FAILURE);
+		throw std::runtime_error{"Astc blocks exceed their storage"};
 	}
 
-	std::cout << "Loading file [" << file_name << "]\n";
-
-	// Obtain file size
-	fseek(compressed_data_file, 0, SEEK_END);
-	auto size = ftell(compressed_data_file);
-	rewind(compressed_data_file);
+	set_storage(std::move(storage), offset);
+}
 
-	// Allocate memory to contain the whole file
-	auto data = new uint8_t[size]();
+Astc::Astc(const std::string &file_path)
+{
+	std::cout << "Loading file [" << file_path << "]\n";
 
-	// Copy the file into the buffer
-	result = fread(data, 1, size, compressed_data_file);
+	// Blocks are read from the page cache on access
+	auto storage = std::make_shared<MappedStorage>(file_path);
 
-	if (result != size)
+	if (storage->get_size() < sizeof(AstcHeader))
 	{
-		std::cerr << "Reading error [" << file_name << "] ... FILE: " << __FILE__ << " LINE: " << __LINE__ << "\n";
-		exit(EXIT_FAILURE);
+		throw std::runtime_error{"Error reading astc [" + file_path + "]: file too small"};
 	}
 
-	// Get the header
-	auto astc_data = reinterpret_cast<AstcHeader *>(data);
-
-	// Merge x,y,z-sizes from 3 chars into one integer value
-	auto width  = astc_data->xsize[0] + (astc_data->xsize[1] << 8) + (astc_data->xsize[2] << 16);
-	auto height = astc_data->ysize[0] + (astc_data->ysize[1] << 8) + (astc_data->ysize[2] << 16);
-	auto depth  = astc_data->zsize[0] + (astc_data->zsize[1] << 8) + (astc_data->zsize[2] << 16);
-
-	block_dim = astc_data->blockdim;
-
-	set_width(width);
-	set_height(height);
-	set_depth(depth);
-
-	// Each block is encoded on 16 bytes, so calculate total compressed image data size
-	size = get_xblocks() * get_yblocks() * get_zblocks() << 4;
-	set_size(size);
+	try
+	{
+		set_header(*reinterpret_cast<const AstcHeader *>(storage->get_data()));
+	}
+	catch (const std::runtime_error &e)
+	{
+		throw std::runtime_error{std::string{e.what()} + " [" + file_path + "]"};
+	}
 
-	// Terminate file operations
-	fclose(compressed_data_file);
+	if (sizeof(AstcHeader) + get_size() > storage->get_size())
+	{
+		throw std::runtime_error{"Error reading astc [" + file_path + "]: truncated block data"};
+	}
 
-	set_memory(data);
+	set_storage(storage, sizeof(AstcHeader));
 }
 
-Image Astc::decode() const
+void Astc::decode(uint8_t *texels, size_t row_stride) const
 {
-	// TODO: What if it is not SRGB?
-	uint32_t bitness = 8;
-
 	if ((block_dim.x < 3 || block_dim.x > 6 || block_dim.y < 3 || block_dim.y > 6 || block_dim.z < 3 || block_dim.z > 6) &&
 	    (block_dim.x < 4 || block_dim.x == 7 || block_dim.x == 9 || block_dim.x == 11 || block_dim.x > 12 ||
 	     block_dim.y < 4 || block_dim.y == 7 || block_dim.y == 9 || block_dim.y == 11 || block_dim.y > 12 || block_dim.z != 1))
@@ -183,50 +353,103 @@ Image Astc::decode() const
 		throw std::runtime_error{"Error reading astc: invalid size"};
 	}
 
-	int xblocks = (width + block_dim.x - 1) / block_dim.x;
-	int yblocks = (height + block_dim.y - 1) / block_dim.y;
-	int zblocks = (depth + block_dim.z - 1) / block_dim.z;
-
-	// Temporary variable where decoded data will go
-	auto astc_image = allocate_image(bitness, width, height, depth, 0);
-	initialize_image(astc_image);
+	assert(swizzle.r < 6 && swizzle.g < 6 && swizzle.b < 6 && swizzle.a < 6 && "Unsupported decode swizzle");
 
-	imageblock pb;
-	for (int z = 0; z < zblocks; z++)
+	if (row_stride == 0)
 	{
-		for (int y = 0; y < yblocks; y++)
+		row_stride = size_t(width) * 4;
+	}
+	auto slice_stride = row_stride * height;
+
+	// Decoding may come before any encode, and its workers must find the tables already built
+	prepare_astc_tables(block_dim);
+
+	int xblocks = get_xblocks();
+	int yblocks = get_yblocks();
+	int zblocks = get_zblocks();
+
+	// Decode a row of blocks per task, writing texels straight to the destination
+	ThreadPool::get_default().parallel_for(yblocks * zblocks, [&](size_t row) {
+		int y = static_cast<int>(row % yblocks);
+		int z = static_cast<int>(row / yblocks);
+
+		// Part of the blocks of this row which lies within the image
+		int ypos    = y * block_dim.y;
+		int zpos    = z * block_dim.z;
+		int ycount  = std::min<int>(block_dim.y, height - ypos);
+		int zcount  = std::min<int>(block_dim.z, depth - zpos);
+		auto blocks = get_data() + row * xblocks * 16;
+
+		imageblock                pb;
+		symbolic_compressed_block scb;
+
+		for (int x = 0; x < xblocks; x++)
 		{
-			for (int x = 0; x < xblocks; x++)
-			{
-				int            offset = (((z * yblocks + y) * xblocks) + x) * 16;
-				const uint8_t *bp     = get_data() + offset;
+			int xpos   = x * block_dim.x;
+			int xcount = std::min<int>(block_dim.x, width - xpos);
 
-				physical_compressed_block pcb = *reinterpret_cast<const physical_compressed_block *>(bp);
-				symbolic_compressed_block scb;
+			auto pcb = reinterpret_cast<const physical_compressed_block *>(blocks + x * 16);
+			physical_to_symbolic(block_dim.x, block_dim.y, block_dim.z, *pcb, &scb);
+			decompress_symbolic_block(decode_mode, block_dim.x, block_dim.y, block_dim.z, xpos, ypos, zpos, &scb, &pb);
 
-				physical_to_symbolic(block_dim.x, block_dim.y, block_dim.z, pcb, &scb);
-				decompress_symbolic_block(decode_mode, block_dim.x, block_dim.y, block_dim.z, x * block_dim.x, y * block_dim.y, z * block_dim.z, &scb, &pb);
-				write_imageblock(astc_image, &pb, block_dim.x, block_dim.y, block_dim.z, x * block_dim.x, y * block_dim.y, z * block_dim.z, swizzle);
+			for (int bz = 0; bz < zcount; bz++)
+			{
+				for (int by = 0; by < ycount; by++)
+				{
+					auto texel = (bz * block_dim.y + by) * block_dim.x;
+					auto dst   = texels + (zpos + bz) * slice_stride + (ypos + by) * row_stride + xpos * 4;
+
+					for (int bx = 0; bx < xcount; bx++, texel++, dst += 4)
+					{
+						if (pb.nan_texel[texel])
+						{
+							// Not displayable, use magenta like the codec does
+							dst[0] = 0xFF;
+							dst[1] = 0x00;
+							dst[2] = 0xFF;
+							dst[3] = 0xFF;
+							continue;
+						}
+
+						// Channels followed by the constants of the swizzle
+						const float *rgba    = pb.orig_data + texel * 4;
+						const float  data[6] = {rgba[0], rgba[1], rgba[2], rgba[3], 0.0f, 1.0f};
+
+						dst[0] = to_unorm8(data[swizzle.r]);
+						dst[1] = to_unorm8(data[swizzle.g]);
+						dst[2] = to_unorm8(data[swizzle.b]);
+						dst[3] = to_unorm8(data[swizzle.a]);
+					}
+				}
 			}
 		}
-	}
-
-	auto data = astc_image->imagedata8[0][0];
-	auto size = size_t(astc_image->xsize * astc_image->ysize * astc_image->zsize * 4);
+	});
+}
 
-	auto image = Image{data, size, static_cast<uint32_t>(width), static_cast<uint32_t>(height), static_cast<uint32_t>(depth)};
+Image Astc::decode() const
+{
+	auto size = size_t(get_width()) * get_height() * get_depth() * 4;
+	auto storage = BufferPool::get_default().allocate(size);
 
-	// destroy_image(astc_image) without relasing astc_image->imagedata8[0][0]
-	delete[] astc_image->imagedata8[0];
-	delete[] astc_image->imagedata8;
+	decode(storage->get_buffer());
 
-	return image;
+	uint32_t gl_format = decode_mode == DECODE_LDR_SRGB ? GL_SRGB8_ALPHA8 : GL_RGBA;
+	return Image{std::move(storage), 0, size, get_width(), get_height(), get_depth(), gl_format};
 }
 
 void Astc::store(const std::string &path) const
 {
-	int thread_count = 4;
-	store_astc_file(codec_image, path.c_str(), block_dim.x, block_dim.y, block_dim.z, &ewp, decode_mode, swizzle, thread_count);
+	// Blocks are already encoded, so write them after their header
+	auto hdr = get_header();
+
+	std::ofstream file{path, std::ios::binary};
+	file.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+	file.write(reinterpret_cast<const char *>(get_data()), get_size());
+
+	if (!file)
+	{
+		throw std::runtime_error{"Cannot store astc [" + path + "]"};
+	}
 }
 
 std::unique_ptr<Image> Astc::resize(const uint32_t w, const uint32_t h)
@@ -234,12 +457,6 @@ std::unique_ptr<Image> Astc::resize(const uint32_t w, const uint32_t h)
 	throw std::runtime_error{"[ERROR] Cannot resize an astc image"};
 }
 
-const uint8_t *Astc::get_data() const
-{
-	auto data = Image::get_data();
-	return data ? data + sizeof(AstcHeader) : nullptr;
-}
-
 uint32_t Astc::get_xblocks() const
 {
 	return (get_width() + block_dim.x - 1) / block_dim.x;
@@ -255,6 +472,11 @@ uint32_t Astc::get_zblocks() const
 	return (get_depth() + block_dim.z - 1) / block_dim.z;
 }
 
+size_t Astc::get_block_count() const
+{
+	return size_t(get_xblocks()) * get_yblocks() * get_zblocks();
+}
+
 std::ostream &operator<<(std::ostream &os, const Astc &astc)
 {
 	os << "ASTC [" << astc.get_size() << " bytes]\n  blocks [" << astc.get_xblocks() << "x" << astc.get_yblocks() << "x" << astc.get_zblocks() << "]\n"
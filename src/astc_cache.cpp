@@ -0,0 +1,290 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/astc_cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#	include <direct.h>
+#else
+#	include <dirent.h>
+#	include <fcntl.h>
+#endif
+
+#include "atk/util.h"
+
+namespace atk
+{
+namespace
+{
+/// Changes whenever the encoder changes the blocks it produces for the same parameters
+const uint32_t CACHE_VERSION = 3;
+
+/// @brief Cache entry found on disk
+struct Entry
+{
+	std::string path;
+
+	/// Last modification time in nanoseconds, as entries used within the same second must keep their order
+	uint64_t last_use;
+
+	uint64_t size;
+};
+
+/// @return Whether a directory exists or could be created
+bool make_directory(const std::string &path)
+{
+#if defined(_WIN32)
+	_mkdir(path.c_str());
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+
+	struct stat info;
+	return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR);
+}
+
+#if !defined(_WIN32)
+/// @return The last modification time of a file in nanoseconds
+uint64_t get_modification_time(const struct stat &info)
+{
+#	if defined(__APPLE__)
+	auto &time = info.st_mtimespec;
+#	else
+	auto &time = info.st_mtim;
+#	endif
+	return uint64_t(time.tv_sec) * 1000000000 + uint64_t(time.tv_nsec);
+}
+#endif
+
+/// @return The entries of the cache directory, temporary files excluded
+std::vector<Entry> list_entries(const std::string &directory)
+{
+	std::vector<Entry> entries;
+
+#if !defined(_WIN32)
+	// Entries are grouped in subdirectories by the first two digits of their key
+	auto dir = opendir(directory.c_str());
+	if (!dir)
+	{
+		return entries;
+	}
+
+	while (auto group = readdir(dir))
+	{
+		std::string group_name = group->d_name;
+		if (group_name.size() != 2 || group_name[0] == '.')
+		{
+			continue;
+		}
+
+		auto group_path = directory + "/" + group_name;
+		auto group_dir  = opendir(group_path.c_str());
+		if (!group_dir)
+		{
+			continue;
+		}
+
+		while (auto file = readdir(group_dir))
+		{
+			std::string name = file->d_name;
+			if (name[0] == '.' || get_extension(name) == "tmp")
+			{
+				continue;
+			}
+
+			auto        path = group_path + "/" + name;
+			struct stat info;
+			if (stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFREG))
+			{
+				entries.push_back({path, get_modification_time(info), static_cast<uint64_t>(info.st_size)});
+			}
+		}
+
+		closedir(group_dir);
+	}
+
+	closedir(dir);
+#endif
+
+	return entries;
+}
+
+}        // namespace
+
+AstcCache::AstcCache(const std::string &d, const uint64_t s) :
+    directory{d},
+    max_size{s}
+{
+	if (!make_directory(directory))
+	{
+		throw std::runtime_error{"Cannot create cache [" + directory + "]"};
+	}
+
+	size = scan();
+}
+
+std::string AstcCache::get_key(const Image &image, const EncodeOptions &options)
+{
+	// Error weighting parameters are derived from the preset and the block dimensions,
+	// while the swizzle and the source format (RGBA8) are fixed by the encoder
+	const uint32_t parameters[] = {
+	    CACHE_VERSION,
+	    image.get_width(),
+	    image.get_height(),
+	    image.get_depth(),
+	    static_cast<uint32_t>(options.preset),
+	    options.block_dim.x,
+	    options.block_dim.y,
+	    options.block_dim.z,
+	    options.srgb ? 1u : 0u,
+	};
+
+	auto seed = get_hash(parameters, sizeof(parameters));
+	return to_hex(get_hash(image.get_data(), image.get_size(), seed));
+}
+
+std::string AstcCache::get_path(const std::string &key) const
+{
+	return directory + "/" + key.substr(0, 2) + "/" + key;
+}
+
+bool AstcCache::load(const std::string &key, uint8_t *blocks, const size_t expected_size)
+{
+	auto path = get_path(key);
+
+	std::ifstream file{path, std::ios::binary | std::ios::ate};
+	if (!file || static_cast<size_t>(file.tellg()) != expected_size)
+	{
+		++miss_count;
+		return false;
+	}
+
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char *>(blocks), expected_size))
+	{
+		++miss_count;
+		return false;
+	}
+
+	// Last modification time tells when an entry was last used
+#if !defined(_WIN32)
+	utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+#endif
+
+	++hit_count;
+	return true;
+}
+
+void AstcCache::store(const std::string &key, const uint8_t *blocks, const size_t entry_size)
+{
+	auto path = get_path(key);
+
+	// The cache is an optimization, failing to store an entry is not an error
+	if (!make_directory(directory + "/" + key.substr(0, 2)))
+	{
+		return;
+	}
+
+	// Other processes never see a partial entry
+	auto temporary_path = get_temporary_path(path);
+
+	std::ofstream file{temporary_path, std::ios::binary};
+	file.write(reinterpret_cast<const char *>(blocks), entry_size);
+	file.close();
+
+	if (!file || std::rename(temporary_path.c_str(), path.c_str()) != 0)
+	{
+		std::remove(temporary_path.c_str());
+		return;
+	}
+
+	size += entry_size;
+	if (size > max_size)
+	{
+		evict();
+	}
+}
+
+uint64_t AstcCache::scan() const
+{
+	uint64_t total = 0;
+	for (auto &entry : list_entries(directory))
+	{
+		total += entry.size;
+	}
+	return total;
+}
+
+void AstcCache::evict()
+{
+	std::lock_guard<std::mutex> lock{eviction_mutex};
+
+	// Another thread may have evicted in the meantime
+	if (size <= max_size)
+	{
+		return;
+	}
+
+	auto entries = list_entries(directory);
+	std::sort(std::begin(entries), std::end(entries), [](const Entry &a, const Entry &b) { return a.last_use < b.last_use; });
+
+	uint64_t total = 0;
+	for (auto &entry : entries)
+	{
+		total += entry.size;
+	}
+
+	// Leave some room, so the next entries do not evict again straight away
+	auto target = max_size / 4 * 3;
+	for (auto &entry : entries)
+	{
+		if (total <= target)
+		{
+			break;
+		}
+
+		if (std::remove(entry.path.c_str()) == 0)
+		{
+			total -= entry.size;
+		}
+	}
+
+	size = total;
+}
+
+uint64_t AstcCache::get_hit_count() const
+{
+	return hit_count;
+}
+
+uint64_t AstcCache::get_miss_count() const
+{
+	return miss_count;
+}
+
+}        // namespace atk
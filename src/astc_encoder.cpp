@@ -1,19 +1,59 @@
 #include "atk/astc.h"
 
 #include <algorithm>
-#include <thread>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include <astc_codec_internals.h>
 
+#include "atk/astc_cache.h"
+#include "atk/buffer_pool.h"
+#include "atk/thread_pool.h"
+#include "atk/trace.h"
+#include "atk/util.h"
+
 namespace atk
 {
+Preset get_preset(const std::string &name)
+{
+	for (auto preset : {Preset::Fastest, Preset::Fast, Preset::Medium, Preset::Thorough, Preset::Exhaustive})
+	{
+		if (name == get_name(preset))
+		{
+			return preset;
+		}
+	}
+
+	throw std::runtime_error{"Unknown preset [" + name + "]"};
+}
+
+const char *get_name(const Preset preset)
+{
+	switch (preset)
+	{
+		case Preset::Fastest:
+			return "fastest";
+		case Preset::Fast:
+			return "fast";
+		case Preset::Medium:
+			return "medium";
+		case Preset::Thorough:
+			return "thorough";
+		case Preset::Exhaustive:
+			return "exhaustive";
+	}
+
+	return "unknown";
+}
+
 /// @param[in] Block dimension
+/// @param[in] preset Speed and quality trade-off
 /// @return Error weighting parameters for that block dimension
-error_weighting_params create_ewp(BlockDim block_dim)
+error_weighting_params create_ewp(BlockDim block_dim, Preset preset)
 {
-	prepare_angular_tables();
-	build_quantization_mode_table();
-
 	error_weighting_params ewp = {};
 
 	ewp.rgb_power         = 1.0f;
@@ -26,127 +66,558 @@ error_weighting_params create_ewp(BlockDim block_dim)
 	ewp.rgba_weights[2] = 1.0f;
 	ewp.rgba_weights[3] = 1.0f;
 
-	// Thorough settings
-	ewp.max_refinement_iters      = 4;
-	ewp.block_mode_cutoff         = 95.0f / 100.0f;
-	ewp.partition_1_to_2_limit    = 2.5f;
-	ewp.lowest_correlation_cutoff = 0.95f;
-	ewp.partition_search_limit    = 100;
+	// Same settings as the astcenc command line presets, where the dB limit
+	// stops the search of a block once it is good enough
+	auto  log10_texels = std::log10(float(block_dim.x * block_dim.y * block_dim.z));
+	float db_limit     = 0.0f;
+
+	switch (preset)
+	{
+		case Preset::Fastest:
+			ewp.max_refinement_iters      = 1;
+			ewp.block_mode_cutoff         = 25.0f / 100.0f;
+			ewp.partition_1_to_2_limit    = 1.0f;
+			ewp.lowest_correlation_cutoff = 0.5f;
+			ewp.partition_search_limit    = 2;
+			db_limit                      = std::max(70.0f - 35.0f * log10_texels, 53.0f - 19.0f * log10_texels);
+			break;
+		case Preset::Fast:
+			ewp.max_refinement_iters      = 1;
+			ewp.block_mode_cutoff         = 50.0f / 100.0f;
+			ewp.partition_1_to_2_limit    = 1.0f;
+			ewp.lowest_correlation_cutoff = 0.5f;
+			ewp.partition_search_limit    = 4;
+			db_limit                      = std::max(85.0f - 35.0f * log10_texels, 63.0f - 19.0f * log10_texels);
+			break;
+		case Preset::Medium:
+			ewp.max_refinement_iters      = 2;
+			ewp.block_mode_cutoff         = 75.0f / 100.0f;
+			ewp.partition_1_to_2_limit    = 1.2f;
+			ewp.lowest_correlation_cutoff = 0.75f;
+			ewp.partition_search_limit    = 25;
+			db_limit                      = std::max(95.0f - 35.0f * log10_texels, 70.0f - 19.0f * log10_texels);
+			break;
+		case Preset::Thorough:
+			ewp.max_refinement_iters      = 4;
+			ewp.block_mode_cutoff         = 95.0f / 100.0f;
+			ewp.partition_1_to_2_limit    = 2.5f;
+			ewp.lowest_correlation_cutoff = 0.95f;
+			ewp.partition_search_limit    = 100;
+			// The default preset searches every block fully, as the encoder always did,
+			// so that its output does not change
+			db_limit = 999.0f;
+			break;
+		case Preset::Exhaustive:
+			ewp.max_refinement_iters      = 4;
+			ewp.block_mode_cutoff         = 100.0f / 100.0f;
+			ewp.partition_1_to_2_limit    = 1000.0f;
+			ewp.lowest_correlation_cutoff = 0.99f;
+			ewp.partition_search_limit    = PARTITION_COUNT;
+			db_limit                      = 999.0f;
+			break;
+	}
+
+	ewp.texel_avg_error_limit = std::pow(0.1f, db_limit * 0.1f) * 65535.0f * 65535.0f;
 
 	expand_block_artifact_suppression(block_dim.x, block_dim.y, block_dim.z, &ewp);
 
 	return ewp;
 }
 
-void Astc::encode()
+/// @brief Builds the parameters of a block dimension and preset along with the codec tables
+///        the first time they are needed, so batches and mip levels reuse them
+/// @return Error weighting parameters shared by every encode with the same settings
+const error_weighting_params &get_ewp(BlockDim block_dim, Preset preset)
 {
-	set_width(codec_image->xsize);
-	set_height(codec_image->ysize);
-	set_depth(codec_image->zsize);
+	static std::mutex                                           mutex;
+	static std::unordered_map<uint32_t, error_weighting_params> ewps;
+
+	auto key = block_dim.x | block_dim.y << 8 | block_dim.z << 16 | static_cast<uint32_t>(preset) << 24;
 
-	auto size = get_xblocks() * get_yblocks() * get_zblocks() * 16;
+	std::lock_guard<std::mutex> lock{mutex};
+
+	auto it = ewps.find(key);
+	if (it == ewps.end())
+	{
+		prepare_astc_tables(block_dim);
+		it = ewps.emplace(key, create_ewp(block_dim, preset)).first;
+	}
+
+	return it->second;
+}
+
+void Astc::allocate(uint8_t *output)
+{
+	auto size = get_block_count() * 16;
 	set_size(size);
 
-	auto data = reinterpret_cast<uint8_t *>(malloc(sizeof(AstcHeader) + size));
-	set_memory(data);
+	if (output)
+	{
+		blocks = output;
+		return;
+	}
+
+	auto storage = BufferPool::get_default().allocate(size);
+	blocks       = storage->get_buffer();
+	set_storage(std::move(storage));
+}
 
-	uint8_t *buffer = data + sizeof(AstcHeader);
-	if (!buffer)
+void Astc::encode_block(const size_t index)
+{
+	auto xblocks = get_xblocks();
+	auto yblocks = get_yblocks();
+
+	uint8_t texels[MAX_TEXELS_PER_BLOCK * 4];
+	read_block(index, texels);
+
+	imageblock pb;
+	pb.xpos = static_cast<int>(index % xblocks) * block_dim.x;
+	pb.ypos = static_cast<int>(index / xblocks % yblocks) * block_dim.y;
+	pb.zpos = static_cast<int>(index / xblocks / yblocks) * block_dim.z;
+
+	// Same conversion as fetch_imageblock, channels followed by the constants of the swizzle
+	float data[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+	int texel_count = block_dim.x * block_dim.y * block_dim.z;
+	for (int i = 0; i < texel_count; ++i)
 	{
-		throw std::runtime_error{"Cannot allocate data for astc image"};
+		for (int c = 0; c < 4; ++c)
+		{
+			data[c] = texels[i * 4 + c] / 255.0f;
+		}
+
+		pb.orig_data[i * 4]     = data[swizzle.r];
+		pb.orig_data[i * 4 + 1] = data[swizzle.g];
+		pb.orig_data[i * 4 + 2] = data[swizzle.b];
+		pb.orig_data[i * 4 + 3] = data[swizzle.a];
+
+		pb.rgb_lns[i]   = rgb_force_use_of_hdr;
+		pb.alpha_lns[i] = alpha_force_use_of_hdr;
+		pb.nan_texel[i] = 0;
 	}
 
-	// Encode
-	int thread_count = 4;
-	encode_astc_image(codec_image, nullptr,
-	                  block_dim.x, block_dim.y, block_dim.z,
-	                  &ewp, decode_mode, swizzle, swizzle, buffer, 0, thread_count);
+	imageblock_initialize_work_from_orig(&pb, texel_count);
+	update_imageblock_flags(&pb, block_dim.x, block_dim.y, block_dim.z);
 
-	AstcHeader &hdr = *reinterpret_cast<AstcHeader *>(data);
+	symbolic_compressed_block scb;
+	compress_symbolic_block(&extent, decode_mode, block_dim.x, block_dim.y, block_dim.z, &ewp, &pb, &scb);
 
-	const uint32_t MAGIC_FILE_CONSTANT = 0x5CA1AB13;
-	hdr.magic[0]                       = MAGIC_FILE_CONSTANT & 0xFF;
-	hdr.magic[1]                       = (MAGIC_FILE_CONSTANT >> 8) & 0xFF;
-	hdr.magic[2]                       = (MAGIC_FILE_CONSTANT >> 16) & 0xFF;
-	hdr.magic[3]                       = (MAGIC_FILE_CONSTANT >> 24) & 0xFF;
-	hdr.blockdim.x                     = block_dim.x;
-	hdr.blockdim.y                     = block_dim.y;
-	hdr.blockdim.z                     = block_dim.z;
-	hdr.xsize[0]                       = get_width() & 0xFF;
-	hdr.xsize[1]                       = (get_width() >> 8) & 0xFF;
-	hdr.xsize[2]                       = (get_width() >> 16) & 0xFF;
-	hdr.ysize[0]                       = get_height() & 0xFF;
-	hdr.ysize[1]                       = (get_height() >> 8) & 0xFF;
-	hdr.ysize[2]                       = (get_height() >> 16) & 0xFF;
-	hdr.zsize[0]                       = get_depth() & 0xFF;
-	hdr.zsize[1]                       = (get_depth() >> 8) & 0xFF;
-	hdr.zsize[2]                       = (get_depth() >> 16) & 0xFF;
+	auto pcb = reinterpret_cast<physical_compressed_block *>(blocks + index * 16);
+	*pcb     = symbolic_to_physical(block_dim.x, block_dim.y, block_dim.z, &scb);
 }
 
-Astc Astc::encode_from(const std::string &file_path)
+/// @return Whether every texel of a block has the color of the first one
+bool is_constant(const uint8_t *texels, const size_t size)
 {
-	Astc astc_image;
+	for (size_t i = 4; i < size; i += 4)
+	{
+		if (!std::equal(texels, texels + 4, texels + i))
+		{
+			return false;
+		}
+	}
+	return true;
+}
 
-	astc_image.ewp = create_ewp(astc_image.block_dim);
+void Astc::read_block(const size_t index, uint8_t *texels) const
+{
+	auto xblocks = get_xblocks();
+	auto yblocks = get_yblocks();
 
-	// Load image
-	int padding            = 0;
-	int load_result        = 0;
-	astc_image.codec_image = astc_codec_load_image(file_path.c_str(), padding, &load_result);
+	uint32_t x = static_cast<uint32_t>(index % xblocks) * block_dim.x;
+	uint32_t y = static_cast<uint32_t>(index / xblocks % yblocks) * block_dim.y;
+	uint32_t z = static_cast<uint32_t>(index / xblocks / yblocks) * block_dim.z;
 
-	if (load_result < 0)
+	auto width  = get_width();
+	auto height = get_height();
+	auto depth  = get_depth();
+
+	// Same clamping as fetch_imageblock, so identical texels give identical blocks
+	for (uint32_t bz = 0; bz < block_dim.z; ++bz)
 	{
-		auto message = "Failed to load " + file_path;
-		throw std::runtime_error{message};
+		auto slice = source.data + std::min(z + bz, depth - 1) * source.slice_stride;
+		for (uint32_t by = 0; by < block_dim.y; ++by)
+		{
+			auto row_index = std::min(y + by, height - 1);
+			if (source.y_flip)
+			{
+				row_index = height - 1 - row_index;
+			}
+
+			auto row = slice + row_index * source.row_stride;
+			for (uint32_t bx = 0; bx < block_dim.x; ++bx, texels += 4)
+			{
+				auto texel = row + std::min(x + bx, width - 1) * source.texel_size;
+				texels[0]  = texel[0];
+				texels[1]  = texel[1];
+				texels[2]  = texel[2];
+				texels[3]  = source.texel_size == 4 ? texel[3] : 0xFF;
+			}
+		}
 	}
+}
 
-	astc_image.encode();
-	return astc_image;
+BlockDim Astc::get_block_extent(const size_t index) const
+{
+	auto xblocks = get_xblocks();
+	auto yblocks = get_yblocks();
+
+	uint32_t x = static_cast<uint32_t>(index % xblocks) * block_dim.x;
+	uint32_t y = static_cast<uint32_t>(index / xblocks % yblocks) * block_dim.y;
+	uint32_t z = static_cast<uint32_t>(index / xblocks / yblocks) * block_dim.z;
+
+	return {static_cast<uint8_t>(std::min<uint32_t>(block_dim.x, get_width() - x)),
+	        static_cast<uint8_t>(std::min<uint32_t>(block_dim.y, get_height() - y)),
+	        static_cast<uint8_t>(std::min<uint32_t>(block_dim.z, get_depth() - z))};
+}
+
+void Astc::set_source(const Source &src)
+{
+	source = src;
+
+	extent.xsize = static_cast<int>(get_width());
+	extent.ysize = static_cast<int>(get_height());
+	extent.zsize = static_cast<int>(get_depth());
 }
 
-astc_codec_image *create_codec_image(Image &image)
+void Astc::set_source(Image &image)
 {
-	int width   = image.get_width();
-	int height  = image.get_height();
-	int depth   = image.get_depth();
-	int padding = 0;
+	Source src;
+	src.data       = image.get_data();
+	src.texel_size = get_channel_count(image.get_gl_format());
 
-	bool y_flip = false;        // TODO make parametric
+	if (src.texel_size != 3 && src.texel_size != 4)
+	{
+		throw std::runtime_error{"Only RGB8 and RGBA8 images can be encoded"};
+	}
 
-	auto imageptr = image.get_data();
+	src.row_stride   = size_t(image.get_width()) * src.texel_size;
+	src.slice_stride = src.row_stride * image.get_height();
 
-	auto astc_img = allocate_image(8, width, height, depth, padding);
+	set_source(src);
+}
 
-	for (int y = 0; y < height; y++)
+void Astc::encode_constant_block(const size_t index, const uint8_t *rgba)
+{
+	// Channels followed by the constants of the swizzle
+	const uint8_t data[6] = {rgba[0], rgba[1], rgba[2], rgba[3], 0, 0xFF};
+
+	// UNORM16 color, as the codec writes constant blocks
+	symbolic_compressed_block scb = {};
+	scb.block_mode                = -2;
+	scb.constant_color[0]         = data[swizzle.r] * 257;
+	scb.constant_color[1]         = data[swizzle.g] * 257;
+	scb.constant_color[2]         = data[swizzle.b] * 257;
+	scb.constant_color[3]         = data[swizzle.a] * 257;
+
+	auto pcb = reinterpret_cast<physical_compressed_block *>(blocks + index * 16);
+	*pcb     = symbolic_to_physical(block_dim.x, block_dim.y, block_dim.z, &scb);
+}
+
+void Astc::encode(const std::vector<Astc *> &astcs, EncodeStats *stats)
+{
+	// Blocks of every image are numbered one after the other,
+	// so a task never waits for the end of a small image
+	std::vector<size_t> first_blocks;
+
+	size_t block_count = 0;
+	for (auto astc : astcs)
 	{
-		int            y_dst = y + padding;
-		int            y_src = y_flip ? (height - y - 1) : y;
-		const uint8_t *src   = imageptr + 4 * width * y_src;
+		// Blocks are compressed by many workers, which must find the tables of the footprint already built
+		prepare_astc_tables(astc->block_dim);
+
+		first_blocks.emplace_back(block_count);
+		block_count += astc->get_block_count();
+	}
 
-		for (int x = 0; x < width; x++)
+	if (block_count == 0)
+	{
+		return;
+	}
+
+	auto block_dim   = astcs.front()->block_dim;
+	auto block_bytes = size_t(block_dim.x) * block_dim.y * block_dim.z * 4;
+
+	// Image of a block and index of the block within it
+	auto locate = [&astcs, &first_blocks](size_t block) {
+		auto it = std::upper_bound(std::begin(first_blocks), std::end(first_blocks), block);
+		auto i  = static_cast<size_t>(std::distance(std::begin(first_blocks), it)) - 1;
+		return std::make_pair(astcs[i], block - first_blocks[i]);
+	};
+
+	// Tasks are made of the same number of blocks, so they cost about the same
+	const size_t blocks_per_task = 16;
+	auto         get_task_count  = [blocks_per_task](size_t count) { return (count + blocks_per_task - 1) / blocks_per_task; };
+
+	// Constant blocks are written straight away, the others are hashed
+	const uint64_t        constant = 0;
+	std::vector<uint64_t> hashes(block_count);
+
+	ThreadPool::get_default().parallel_for(get_task_count(block_count), [&](size_t task) {
+		std::vector<uint8_t> texels(block_bytes);
+
+		auto last = std::min((task + 1) * blocks_per_task, block_count);
+		for (auto block = task * blocks_per_task; block < last; ++block)
 		{
-			int x_dst                                     = x + padding;
-			astc_img->imagedata8[0][y_dst][4 * x_dst]     = src[4 * x];
-			astc_img->imagedata8[0][y_dst][4 * x_dst + 1] = src[4 * x + 1];
-			astc_img->imagedata8[0][y_dst][4 * x_dst + 2] = src[4 * x + 2];
-			astc_img->imagedata8[0][y_dst][4 * x_dst + 3] = src[4 * x + 3];
+			auto location = locate(block);
+			location.first->read_block(location.second, texels.data());
+
+			if (is_constant(texels.data(), block_bytes))
+			{
+				location.first->encode_constant_block(location.second, texels.data());
+				hashes[block] = constant;
+			}
+			else
+			{
+				// Clamping repeats edge texels, so an edge block may read like an inner one,
+				// and only blocks with the same visible extent share an encoding
+				auto           extent     = location.first->get_block_extent(location.second);
+				const uint8_t  extents[3] = {extent.x, extent.y, extent.z};
+				const uint64_t seed       = get_hash(extents, sizeof(extents));
+
+				// Never equal to the constant marker
+				hashes[block] = get_hash(texels.data(), block_bytes, seed) | 1;
+			}
+		}
+	});
+
+	// First block of each content, the others copy its encoding
+	std::vector<size_t> unique_blocks;
+	std::vector<size_t> duplicate_blocks;
+	std::vector<size_t> sources(block_count);
+
+	std::unordered_map<uint64_t, size_t> first_of_hash;
+	for (size_t block = 0; block < block_count; ++block)
+	{
+		if (hashes[block] == constant)
+		{
+			continue;
+		}
+
+		auto found = first_of_hash.emplace(hashes[block], block);
+		if (found.second)
+		{
+			unique_blocks.emplace_back(block);
+		}
+		else
+		{
+			sources[block] = found.first->second;
+			duplicate_blocks.emplace_back(block);
 		}
 	}
 
-	fill_image_padding_area(astc_img);
+	ThreadPool::get_default().parallel_for(get_task_count(unique_blocks.size()), [&](size_t task) {
+		auto last = std::min((task + 1) * blocks_per_task, unique_blocks.size());
+		for (auto i = task * blocks_per_task; i < last; ++i)
+		{
+			auto location = locate(unique_blocks[i]);
+			location.first->encode_block(location.second);
+		}
+	});
+
+	// Hashes may collide, so texels are compared before copying
+	std::atomic<uint64_t> collision_count{0};
 
-	return astc_img;
+	ThreadPool::get_default().parallel_for(get_task_count(duplicate_blocks.size()), [&](size_t task) {
+		std::vector<uint8_t> texels(block_bytes);
+		std::vector<uint8_t> source_texels(block_bytes);
+
+		auto last = std::min((task + 1) * blocks_per_task, duplicate_blocks.size());
+		for (auto i = task * blocks_per_task; i < last; ++i)
+		{
+			auto location        = locate(duplicate_blocks[i]);
+			auto source_location = locate(sources[duplicate_blocks[i]]);
+
+			location.first->read_block(location.second, texels.data());
+			source_location.first->read_block(source_location.second, source_texels.data());
+
+			auto extent        = location.first->get_block_extent(location.second);
+			auto source_extent = source_location.first->get_block_extent(source_location.second);
+
+			if (extent == source_extent && texels == source_texels)
+			{
+				auto source = source_location.first->blocks + source_location.second * 16;
+				std::copy(source, source + 16, location.first->blocks + location.second * 16);
+			}
+			else
+			{
+				location.first->encode_block(location.second);
+				++collision_count;
+			}
+		}
+	});
+
+	if (stats)
+	{
+		auto constant_count = block_count - unique_blocks.size() - duplicate_blocks.size();
+
+		stats->block_count += block_count;
+		stats->constant_block_count += constant_count;
+		stats->duplicate_block_count += duplicate_blocks.size() - collision_count;
+	}
+}
+
+/// @return The astc GL format of the encoding options
+uint32_t get_encode_gl_format(const EncodeOptions &options)
+{
+	auto gl_format = get_astc_gl_format(options.block_dim, options.srgb);
+	if (gl_format == 0)
+	{
+		throw std::runtime_error{"Invalid astc block footprint"};
+	}
+	return gl_format;
 }
 
-Astc Astc::encode_from(Image &image)
+Astc Astc::encode_from(const std::string &file_path, const EncodeOptions &options)
 {
 	Astc astc_image;
 
-	astc_image.ewp         = create_ewp(astc_image.block_dim);
-	astc_image.codec_image = create_codec_image(image);
+	astc_image.set_gl_format(get_encode_gl_format(options));
+	astc_image.ewp = get_ewp(astc_image.block_dim, options.preset);
+
+	// Load image
+	int  padding     = 0;
+	int  load_result = 0;
+	auto codec_image = astc_codec_load_image(file_path.c_str(), padding, &load_result);
+
+	if (load_result < 0)
+	{
+		auto message = "Failed to load " + file_path;
+		throw std::runtime_error{message};
+	}
+
+	// Only needed while encoding
+	auto guard = std::unique_ptr<astc_codec_image, void (*)(astc_codec_image *)>{codec_image, destroy_image};
 
-	astc_image.encode();
+	if (!codec_image->imagedata8)
+	{
+		throw std::runtime_error{"Only 8 bit images can be encoded [" + file_path + "]"};
+	}
+
+	astc_image.set_width(codec_image->xsize);
+	astc_image.set_height(codec_image->ysize);
+	astc_image.set_depth(codec_image->zsize);
+
+	// Texels of the codec image are stored in a single block of memory
+	Source source;
+	source.data         = codec_image->imagedata8[0][0];
+	source.row_stride   = size_t(codec_image->xsize) * 4;
+	source.slice_stride = source.row_stride * codec_image->ysize;
+	astc_image.set_source(source);
+
+	astc_image.allocate();
+	encode({&astc_image}, options.stats);
+
+	astc_image.source = {};
 	return astc_image;
 }
 
+Astc Astc::encode_from(Image &image, const EncodeOptions &options)
+{
+	auto astcs = encode_from(std::vector<Image *>{&image}, options);
+	return std::move(astcs.front());
+}
+
+std::vector<Astc> Astc::create_from(const std::vector<Image *> &images, const EncodeOptions &options)
+{
+	std::vector<Astc> astcs;
+	if (images.empty())
+	{
+		return astcs;
+	}
+
+	auto gl_format = get_encode_gl_format(options);
+	auto &ewp      = get_ewp(options.block_dim, options.preset);
+
+	astcs.reserve(images.size());
+	for (auto image : images)
+	{
+		astcs.emplace_back(Astc{});
+
+		auto &astc = astcs.back();
+		astc.set_gl_format(gl_format);
+		astc.set_width(image->get_width());
+		astc.set_height(image->get_height());
+		astc.set_depth(image->get_depth());
+		astc.ewp = ewp;
+	}
+
+	return astcs;
+}
+
+std::vector<Astc> Astc::encode_from(const std::vector<Image *> &images, const EncodeOptions &options)
+{
+	auto astcs = create_from(images, options);
+
+	// Blocks are encoded into memory owned by the new images
+	std::vector<uint8_t *> outputs;
+	for (auto &astc : astcs)
+	{
+		astc.allocate();
+		outputs.emplace_back(astc.blocks);
+	}
+
+	encode_to(images, outputs, options);
+	return astcs;
+}
+
+void Astc::encode_to(const std::vector<Image *> &images, const std::vector<uint8_t *> &outputs, const EncodeOptions &options)
+{
+	assert(images.size() == outputs.size() && "Each image needs an output");
+
+	// Levels are encoded together, so they are traced as one stage
+	uint64_t bytes = 0;
+	for (auto image : images)
+	{
+		bytes += image->get_size();
+	}
+	TraceScope trace{"encode", -1, bytes};
+
+	// Only used while encoding, their blocks belong to the outputs
+	auto astcs = create_from(images, options);
+	for (size_t i = 0; i < astcs.size(); ++i)
+	{
+		astcs[i].allocate(outputs[i]);
+	}
+
+	std::vector<std::string> keys(images.size());
+
+	// Images found in the cache are copied to their output, the others are
+	// read straight from their memory while encoding
+	ThreadPool::get_default().parallel_for(images.size(), [&astcs, &images, &outputs, &options, &keys](size_t i) {
+		if (options.cache)
+		{
+			keys[i] = AstcCache::get_key(*images[i], options);
+			if (options.cache->load(keys[i], outputs[i], astcs[i].get_size()))
+			{
+				return;
+			}
+		}
+
+		astcs[i].set_source(*images[i]);
+	});
+
+	std::vector<Astc *> pointers;
+	for (auto &astc : astcs)
+	{
+		if (astc.source.data)
+		{
+			pointers.emplace_back(&astc);
+		}
+	}
+
+	encode(pointers, options.stats);
+
+	if (options.cache)
+	{
+		for (size_t i = 0; i < astcs.size(); ++i)
+		{
+			if (astcs[i].source.data)
+			{
+				options.cache->store(keys[i], outputs[i], astcs[i].get_size());
+			}
+		}
+	}
+}
+
 }        // namespace atk
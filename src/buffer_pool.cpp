@@ -0,0 +1,252 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/buffer_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#	include <malloc.h>
+#else
+#	include <sys/mman.h>
+#endif
+
+namespace atk
+{
+PooledStorage::PooledStorage(BufferPool &p, uint8_t *d, const size_t s, const size_t c, const bool m) :
+    pool{p},
+    data{d},
+    size{s},
+    capacity{c},
+    mapped{m}
+{
+}
+
+PooledStorage::~PooledStorage()
+{
+	pool.release(data, capacity, mapped);
+}
+
+const uint8_t *PooledStorage::get_data() const
+{
+	return data;
+}
+
+size_t PooledStorage::get_size() const
+{
+	return size;
+}
+
+uint8_t *PooledStorage::get_buffer()
+{
+	return data;
+}
+
+/// @return The capacity of the size class of a buffer, there are four classes
+///         between two powers of two so at most a quarter of a buffer is unused
+size_t get_size_class(const size_t size)
+{
+	const size_t min_capacity = 4096;
+	if (size <= min_capacity)
+	{
+		return min_capacity;
+	}
+
+	size_t power = min_capacity;
+	while (power * 2 < size)
+	{
+		power *= 2;
+	}
+
+	auto step = power / 4;
+	return (size + step - 1) / step * step;
+}
+
+BufferPool::BufferPool(const size_t m) :
+    max_cached_size{m}
+{
+}
+
+BufferPool::~BufferPool()
+{
+	trim();
+}
+
+std::shared_ptr<PooledStorage> BufferPool::allocate(const size_t size)
+{
+	auto capacity = get_size_class(size);
+	bool mapped   = false;
+
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+
+		++stats.allocation_count;
+		stats.used_size += capacity;
+		stats.peak_used_size = std::max(stats.peak_used_size, stats.used_size);
+
+		// Most recent buffer of the class, its memory is more likely to be cached
+		auto it = std::find_if(free_buffers.rbegin(), free_buffers.rend(), [capacity](const Buffer &b) { return b.capacity == capacity; });
+		if (it != free_buffers.rend())
+		{
+			auto buffer = *it;
+			free_buffers.erase(std::next(it).base());
+
+			++stats.reuse_count;
+			stats.cached_size -= capacity;
+
+			return std::shared_ptr<PooledStorage>{new PooledStorage{*this, buffer.data, size, buffer.capacity, buffer.mapped}};
+		}
+
+		++stats.system_allocation_count;
+
+#if !defined(_WIN32)
+		mapped = huge_page_threshold > 0 && capacity >= huge_page_threshold;
+#endif
+	}
+
+	uint8_t *data = nullptr;
+
+#if defined(_WIN32)
+	data = reinterpret_cast<uint8_t *>(_aligned_malloc(capacity, alignment));
+#else
+	if (mapped)
+	{
+		auto mapping = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping != MAP_FAILED)
+		{
+			data = reinterpret_cast<uint8_t *>(mapping);
+#	if defined(MADV_HUGEPAGE)
+			// A hint, the mapping works all the same when it is ignored
+			madvise(mapping, capacity, MADV_HUGEPAGE);
+#	endif
+		}
+	}
+	else
+	{
+		void *memory = nullptr;
+		if (posix_memalign(&memory, alignment, capacity) == 0)
+		{
+			data = reinterpret_cast<uint8_t *>(memory);
+		}
+	}
+#endif
+
+	if (!data)
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		stats.used_size -= capacity;
+		throw std::bad_alloc{};
+	}
+
+	return std::shared_ptr<PooledStorage>{new PooledStorage{*this, data, size, capacity, mapped}};
+}
+
+void BufferPool::release(uint8_t *data, const size_t capacity, const bool mapped)
+{
+	std::vector<Buffer> evicted;
+
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+
+		stats.used_size -= capacity;
+
+		if (capacity > max_cached_size)
+		{
+			evicted.emplace_back(Buffer{data, capacity, mapped});
+		}
+		else
+		{
+			// Oldest buffers make room for this one
+			auto first = std::begin(free_buffers);
+			auto last  = first;
+			while (stats.cached_size + capacity > max_cached_size)
+			{
+				stats.cached_size -= last->capacity;
+				++last;
+			}
+			evicted.assign(first, last);
+			free_buffers.erase(first, last);
+
+			free_buffers.emplace_back(Buffer{data, capacity, mapped});
+			stats.cached_size += capacity;
+		}
+	}
+
+	// Outside the lock, giving memory back to the system can be slow
+	for (auto &buffer : evicted)
+	{
+		free_buffer(buffer.data, buffer.capacity, buffer.mapped);
+	}
+}
+
+void BufferPool::free_buffer(uint8_t *data, const size_t capacity, const bool mapped)
+{
+#if defined(_WIN32)
+	_aligned_free(data);
+#else
+	if (mapped)
+	{
+		munmap(data, capacity);
+	}
+	else
+	{
+		free(data);
+	}
+#endif
+}
+
+void BufferPool::trim()
+{
+	std::vector<Buffer> evicted;
+
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		evicted.swap(free_buffers);
+		stats.cached_size = 0;
+	}
+
+	for (auto &buffer : evicted)
+	{
+		free_buffer(buffer.data, buffer.capacity, buffer.mapped);
+	}
+}
+
+void BufferPool::set_huge_page_threshold(const size_t size)
+{
+	std::lock_guard<std::mutex> lock{mutex};
+	huge_page_threshold = size;
+}
+
+BufferPool::Stats BufferPool::get_stats() const
+{
+	std::lock_guard<std::mutex> lock{mutex};
+	return stats;
+}
+
+BufferPool &BufferPool::get_default()
+{
+	// Leaked on purpose, so images destroyed at exit can still return their memory
+	static auto pool = new BufferPool{};
+	return *pool;
+}
+
+}        // namespace atk
@@ -0,0 +1,210 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/footprint.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "atk/buffer_pool.h"
+#include "atk/magick.h"
+#include "atk/metrics.h"
+#include "atk/thread_pool.h"
+#include "atk/trace.h"
+
+namespace atk
+{
+namespace
+{
+/// Side of the tiles, a multiple of every 2D footprint dimension
+const uint32_t tile_size = 120;
+
+/// Maximum tiles along each dimension
+const uint32_t max_tiles = 4;
+
+/// @return The first coordinate of each tile, spread evenly over a dimension
+std::vector<uint32_t> get_tile_starts(const uint32_t size, const uint32_t tile, const uint32_t count)
+{
+	if (count == 1)
+	{
+		return {(size - tile) / 2};
+	}
+
+	std::vector<uint32_t> starts;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		starts.emplace_back(static_cast<uint32_t>(uint64_t(size - tile) * i / (count - 1)));
+	}
+	return starts;
+}
+
+}        // namespace
+
+Image sample_tiles(Image &image)
+{
+	auto channels = get_channel_count(image.get_gl_format());
+	if (channels != 3 && channels != 4)
+	{
+		throw std::runtime_error{"Only RGB8 and RGBA8 images can be sampled"};
+	}
+
+	auto width  = image.get_width();
+	auto height = image.get_height();
+
+	auto tile_width  = std::min(tile_size, width);
+	auto tile_height = std::min(tile_size, height);
+	auto columns     = std::min(max_tiles, width / tile_width);
+	auto rows        = std::min(max_tiles, height / tile_height);
+
+	// Small images are their own proxy
+	if (uint64_t(width) * height <= uint64_t(columns * tile_width) * (rows * tile_height) * 2)
+	{
+		columns     = 1;
+		rows        = 1;
+		tile_width  = width;
+		tile_height = height;
+	}
+
+	auto proxy_width  = columns * tile_width;
+	auto proxy_height = rows * tile_height;
+	auto proxy_size   = size_t(proxy_width) * proxy_height * 4;
+	auto storage      = BufferPool::get_default().allocate(proxy_size);
+	auto proxy        = storage->get_buffer();
+
+	auto magick   = dynamic_cast<MagickImage *>(&image);
+	auto row_size = size_t(width) * channels;
+
+	std::vector<uint8_t> band;
+	if (magick)
+	{
+		band.resize(row_size * tile_height);
+	}
+
+	auto tile_xs = get_tile_starts(width, tile_width, columns);
+	auto tile_ys = get_tile_starts(height, tile_height, rows);
+
+	for (uint32_t j = 0; j < rows; ++j)
+	{
+		// Rows of a band of tiles
+		const uint8_t *src = nullptr;
+		if (magick)
+		{
+			magick->export_rows(tile_ys[j], tile_height, band.data());
+			src = band.data();
+		}
+		else
+		{
+			src = image.get_data() + tile_ys[j] * row_size;
+		}
+
+		for (uint32_t y = 0; y < tile_height; ++y)
+		{
+			auto dst = proxy + (size_t(j) * tile_height + y) * proxy_width * 4;
+			for (uint32_t i = 0; i < columns; ++i)
+			{
+				auto tile_dst = dst + size_t(i) * tile_width * 4;
+				auto tile_src = src + y * row_size + size_t(tile_xs[i]) * channels;
+				if (channels == 4)
+				{
+					std::memcpy(tile_dst, tile_src, size_t(tile_width) * 4);
+					continue;
+				}
+
+				// Opaque RGBA texels, the image itself is left as it is
+				for (uint32_t x = 0; x < tile_width; ++x, tile_dst += 4, tile_src += 3)
+				{
+					tile_dst[0] = tile_src[0];
+					tile_dst[1] = tile_src[1];
+					tile_dst[2] = tile_src[2];
+					tile_dst[3] = 0xFF;
+				}
+			}
+		}
+	}
+
+	return Image{std::move(storage), 0, proxy_size, proxy_width, proxy_height, 1, GL_RGBA};
+}
+
+const std::vector<BlockDim> &get_footprint_candidates()
+{
+	static const std::vector<BlockDim> footprints = {
+	    {12, 12, 1},
+	    {12, 10, 1},
+	    {10, 10, 1},
+	    {10, 8, 1},
+	    {8, 8, 1},
+	    {10, 6, 1},
+	    {10, 5, 1},
+	    {8, 6, 1},
+	    {8, 5, 1},
+	    {6, 6, 1},
+	    {6, 5, 1},
+	    {5, 5, 1},
+	    {5, 4, 1},
+	    {4, 4, 1},
+	};
+	return footprints;
+}
+
+FootprintChoice select_footprint(Image &image, const double target_psnr, const EncodeOptions &options)
+{
+	TraceScope trace{"footprint"};
+
+	auto proxy = sample_tiles(image);
+
+	// Trials neither touch the cache nor the counters of the real encode
+	EncodeOptions trial_options = options;
+	trial_options.cache         = nullptr;
+	trial_options.stats         = nullptr;
+
+	MetricsOptions metrics_options;
+	metrics_options.ssim = false;
+
+	// Trials run together on the pool, each one encoding its blocks on it as well
+	auto               &footprints = get_footprint_candidates();
+	std::vector<double> psnrs(footprints.size());
+	ThreadPool::get_default().parallel_for(footprints.size(), [&](size_t i) {
+		auto footprint_options      = trial_options;
+		footprint_options.block_dim = footprints[i];
+
+		auto decoded = Astc::encode_from(proxy, footprint_options).decode();
+		psnrs[i]     = measure(proxy, decoded, metrics_options).get_psnr();
+	});
+
+	// Footprints go from the lowest bitrate, so the first one meeting the target is the cheapest
+	FootprintChoice choice;
+	for (size_t i = 0; i < footprints.size(); ++i)
+	{
+		choice.block_dim = footprints[i];
+		choice.psnr      = psnrs[i];
+		if (choice.psnr >= target_psnr)
+		{
+			choice.met = true;
+			break;
+		}
+	}
+
+	// Otherwise the smallest footprint comes closest
+	return choice;
+}
+
+}        // namespace atk
@@ -1,25 +1,88 @@
 #include "atk/image.h"
 
+#include "atk/buffer_pool.h"
+
 namespace atk
 {
-float Image::diff(const Image &b) const
+uint32_t get_channel_count(const uint32_t gl_format)
 {
-	if (get_size() != b.get_size())
+	switch (gl_format)
 	{
-		return 1.0f;        // Different size, different images
+		case GL_RGB:
+		case GL_SRGB8:
+			return 3;
+		case GL_RGBA:
+		case GL_SRGB8_ALPHA8:
+			return 4;
+		default:
+			return 0;
 	}
+}
+
+bool is_srgb(const uint32_t gl_format)
+{
+	return gl_format == GL_SRGB8 || gl_format == GL_SRGB8_ALPHA8 ||
+	       (gl_format >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR && gl_format <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR) ||
+	       (gl_format >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_3x3x3_OES && gl_format <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6x6_OES);
+}
 
-	float diff = 0.0f;
+void Image::convert(const Format format)
+{
+	auto channels = get_channel_count(get_gl_format());
 
-	auto a_data = get_data();
-	auto b_data = b.get_data();
+	uint32_t target_channels = 0;
+	switch (format)
+	{
+		case Format::RGB:
+			target_channels = 3;
+			break;
+		case Format::RGBA:
+			target_channels = 4;
+			break;
+		default:
+			break;
+	}
+
+	if (channels == 0 || target_channels == 0)
+	{
+		throw std::runtime_error{"Unimplemented"};
+	}
 
-	for (size_t i = 0; i < get_size(); ++i)
+	if (channels == target_channels)
 	{
-		diff += std::abs(static_cast<int8_t>(a_data[i]) - static_cast<int8_t>(b_data[i]));
+		return;        // already there
 	}
 
-	return diff / get_size() / 255.0f;
+	auto texel_count = size_t(width) * height * depth;
+	auto src         = get_data();
+	auto dst_storage = BufferPool::get_default().allocate(texel_count * target_channels);
+	auto dst         = dst_storage->get_buffer();
+
+	for (size_t i = 0; i < texel_count; ++i)
+	{
+		dst[i * target_channels + 0] = src[i * channels + 0];
+		dst[i * target_channels + 1] = src[i * channels + 1];
+		dst[i * target_channels + 2] = src[i * channels + 2];
+
+		// Opaque alpha when adding one
+		if (target_channels == 4)
+		{
+			dst[i * target_channels + 3] = 0xFF;
+		}
+	}
+
+	size    = texel_count * target_channels;
+	storage = std::move(dst_storage);
+	data    = dst;
+
+	if (target_channels == 4)
+	{
+		gl_format = is_srgb(gl_format) ? GL_SRGB8_ALPHA8 : GL_RGBA;
+	}
+	else
+	{
+		gl_format = is_srgb(gl_format) ? GL_SRGB8 : GL_RGB;
+	}
 }
 
 }        // namespace atk
\ No newline at end of file
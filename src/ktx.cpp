@@ -1,11 +1,13 @@
 #include "atk/ktx.h"
 
+#include <algorithm>
 #include <cassert>
 
 #include <Magick++.h>
 #include <gl_format.h>
 
 #include "atk/astc.h"
+#include "atk/buffer_pool.h"
 
 namespace atk
 {
@@ -82,10 +84,6 @@ Ktx::Ktx(const std::string &file_path)
 /// @return The right gl format
 ktx_uint32_t get_internal_format(Texture &texture)
 {
-	// Call this function for all mipmaps to make sure a proper
-	// conversion happens in accord the GL format returned
-	auto &mipmaps = texture.get_mipmap_chain();
-	std::for_each(std::begin(mipmaps), std::end(mipmaps), [](auto &mipmap) { mipmap->get_gl_format(); });
 	return texture.get_image().get_gl_format();
 }
 
@@ -93,9 +91,9 @@ Ktx::Ktx(Texture &texture)
 {
 	ktxTextureCreateInfo info = {};
 
-	// Not array texture
-	info.numLayers = 1;
-	info.isArray   = KTX_FALSE;
+	// A single layer is not an array texture
+	info.numLayers = texture.get_layer_count();
+	info.isArray   = texture.get_layer_count() > 1 ? KTX_TRUE : KTX_FALSE;
 
 	info.glInternalformat = get_internal_format(texture);
 
@@ -106,8 +104,7 @@ Ktx::Ktx(Texture &texture)
 
 	info.numDimensions = 2;        // 2D texture
 
-	// TODO Handle cubemap?
-	info.numFaces = 1;
+	info.numFaces = texture.get_face_count();
 
 	info.generateMipmaps = texture.get_mipmap_chain().empty() ? KTX_TRUE : KTX_FALSE;
 	info.numLevels       = texture.get_levels();
@@ -119,37 +116,21 @@ Ktx::Ktx(Texture &texture)
 		throw Ktx::Exception{result, "Cannot create KTX texture"};
 	}
 
-	auto src  = reinterpret_cast<const ktx_uint8_t *>(image.get_data());
-	auto size = static_cast<ktx_size_t>(image.get_size());
-	result    = ktxTexture_SetImageFromMemory(ktx_texture,
-                                           /* level = */ 0,
-                                           /* layer = */ 0,
-                                           /* face = */ 0,
-                                           src,
-                                           size);
-	if (result != KTX_SUCCESS)
-	{
-		throw Ktx::Exception{result, "Cannot set image to KTX texture"};
-	}
-
-	// Set mipmap chain
-	if (!texture.get_mipmap_chain().empty())
+	// Set every level of every layer and face
+	for (ktx_uint32_t level = 0; level < info.numLevels; ++level)
 	{
-		for (ktx_uint32_t level = 1; level < info.numLevels; ++level)
+		for (ktx_uint32_t layer = 0; layer < info.numLayers; ++layer)
 		{
-			auto  i      = level - 1;
-			auto &mipmap = texture.get_mipmap_chain()[i];
-			auto  src    = reinterpret_cast<const ktx_uint8_t *>(mipmap->get_data());
-			auto  size   = static_cast<ktx_size_t>(mipmap->get_size());
-			result       = ktxTexture_SetImageFromMemory(ktx_texture,
-                                                   level,
-                                                   /* layer = */ 0,
-                                                   /* face = */ 0,
-                                                   src,
-                                                   size);
-			if (result != KTX_SUCCESS)
+			for (ktx_uint32_t face = 0; face < info.numFaces; ++face)
 			{
-				throw Ktx::Exception{result, "Cannot set image to KTX texture"};
+				auto &level_image = texture.get_level(level, layer, face);
+				auto  src         = reinterpret_cast<const ktx_uint8_t *>(level_image.get_data());
+				auto  size        = static_cast<ktx_size_t>(level_image.get_size());
+				result            = ktxTexture_SetImageFromMemory(ktx_texture, level, layer, face, src, size);
+				if (result != KTX_SUCCESS)
+				{
+					throw Ktx::Exception{result, "Cannot set image to KTX texture"};
+				}
 			}
 		}
 	}
@@ -234,54 +215,7 @@ size_t Ktx::get_depth() const
 
 bool is_astc(ktx_uint32_t gl_format)
 {
-	return gl_format == GL_COMPRESSED_RGBA_ASTC_4x4_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_5x4_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_5x5_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_6x5_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_6x6_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_8x5_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_8x6_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_8x8_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_10x5_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_10x6_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_10x8_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_10x10_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_12x10_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_12x12_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x5_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x6_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x5_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x6_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x8_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_10x10_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x10_KHR ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_3x3x3_OES ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_4x3x3_OES ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_4x4x3_OES ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_4x4x4_OES ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_5x4x4_OES ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_5x5x4_OES ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_5x5x5_OES ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_6x5x5_OES ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_6x6x5_OES ||
-	       gl_format == GL_COMPRESSED_RGBA_ASTC_6x6x6_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_3x3x3_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x3x3_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4x3_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4x4_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x4x4_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5x4_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_5x5x5_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x5x5_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6x5_OES ||
-	       gl_format == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6x6_OES;
+	return get_block_dim(gl_format).x != 0;
 }
 
 std::unique_ptr<Image> Ktx::get_image()
@@ -295,13 +229,14 @@ std::unique_ptr<Image> Ktx::get_image()
 	if (is_astc(ktx_texture->glInternalformat))
 	{
 		// Data has no astc header
-		return std::unique_ptr<Astc>(new Astc{width, height, depth, data});
+		return std::unique_ptr<Astc>(new Astc{width, height, depth, data, ktx_texture->glInternalformat});
 	}
 
-	size_t size = ktxTexture_GetSize(ktx_texture);
-	// Image will take ownership
-	ktx_texture->pData = nullptr;
-	return std::unique_ptr<Image>(new Image{data, size, width, height, depth});
+	// Data is allocated by libktx with malloc and stays owned by the texture
+	size_t size    = ktxTexture_GetSize(ktx_texture);
+	auto   storage = BufferPool::get_default().allocate(size);
+	std::copy(data, data + size, storage->get_buffer());
+	return std::unique_ptr<Image>(new Image{std::move(storage), 0, size, width, height, depth, ktx_texture->glInternalformat});
 }
 
 void Ktx::save_to_file(const std::string &file_name) const
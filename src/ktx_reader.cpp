@@ -0,0 +1,233 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/ktx_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "atk/astc.h"
+#include "atk/buffer_pool.h"
+
+namespace atk
+{
+namespace
+{
+uint32_t swap_bytes(const uint32_t value)
+{
+	return (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+}
+
+}        // namespace
+
+KtxReader::KtxReader(const std::string &path) :
+    storage{std::make_shared<MappedStorage>(path)}
+{
+	auto data = storage->get_data();
+	auto size = storage->get_size();
+
+	if (size < sizeof(KtxHeader))
+	{
+		throw std::runtime_error{"Error reading KTX [" + path + "]: file too small"};
+	}
+
+	std::memcpy(&header, data, sizeof(header));
+
+	if (!std::equal(std::begin(KTX_IDENTIFIER), std::end(KTX_IDENTIFIER), header.identifier))
+	{
+		throw std::runtime_error{"Error reading KTX [" + path + "]: not a KTX file"};
+	}
+
+	// Files written with the other endianness need their fields swapped
+	bool swapped = header.endianness != KTX_ENDIANNESS;
+	if (swapped)
+	{
+		if (header.endianness != swap_bytes(KTX_ENDIANNESS))
+		{
+			throw std::runtime_error{"Error reading KTX [" + path + "]: invalid endianness"};
+		}
+
+		auto fields = reinterpret_cast<uint32_t *>(&header.endianness);
+		for (size_t i = 0; i < (sizeof(header) - sizeof(header.identifier)) / sizeof(uint32_t); ++i)
+		{
+			fields[i] = swap_bytes(fields[i]);
+		}
+
+		// Texels bigger than a byte would need swapping as well
+		if (header.gl_type_size > 1)
+		{
+			throw std::runtime_error{"Error reading KTX [" + path + "]: unsupported endianness"};
+		}
+	}
+
+	if (header.number_of_faces != 1 && header.number_of_faces != 6)
+	{
+		throw std::runtime_error{"Error reading KTX [" + path + "]: invalid number of faces"};
+	}
+
+	auto level_count = get_level_count();
+	auto image_count = get_layer_count() * get_face_count();
+
+	// Only non array cubemaps give the size of a single face and pad each face
+	bool cubemap = header.number_of_faces == 6 && header.number_of_array_elements == 0;
+
+	size_t offset = sizeof(KtxHeader) + header.bytes_of_key_value_data;
+
+	for (uint32_t level = 0; level < level_count; ++level)
+	{
+		if (offset + sizeof(uint32_t) > size)
+		{
+			throw std::runtime_error{"Error reading KTX [" + path + "]: truncated level index"};
+		}
+
+		uint32_t image_size = 0;
+		std::memcpy(&image_size, data + offset, sizeof(image_size));
+		if (swapped)
+		{
+			image_size = swap_bytes(image_size);
+		}
+		offset += sizeof(uint32_t);
+
+		size_t level_size = 0;
+		if (cubemap)
+		{
+			image_sizes.emplace_back(image_size);
+			image_strides.emplace_back(align4(image_size));
+			level_size = image_count * align4(image_size);
+		}
+		else
+		{
+			image_sizes.emplace_back(image_size / image_count);
+			image_strides.emplace_back(image_size / image_count);
+			level_size = align4(image_size);
+		}
+
+		if (offset + level_size > size)
+		{
+			throw std::runtime_error{"Error reading KTX [" + path + "]: truncated level data"};
+		}
+
+		level_offsets.emplace_back(offset);
+		offset += level_size;
+	}
+}
+
+uint32_t KtxReader::get_gl_format() const
+{
+	return header.gl_internal_format;
+}
+
+uint32_t KtxReader::get_width() const
+{
+	return header.pixel_width;
+}
+
+uint32_t KtxReader::get_height() const
+{
+	return std::max(header.pixel_height, 1u);
+}
+
+uint32_t KtxReader::get_depth() const
+{
+	return std::max(header.pixel_depth, 1u);
+}
+
+uint32_t KtxReader::get_level_count() const
+{
+	return std::max(header.number_of_mipmap_levels, 1u);
+}
+
+uint32_t KtxReader::get_layer_count() const
+{
+	return std::max(header.number_of_array_elements, 1u);
+}
+
+uint32_t KtxReader::get_face_count() const
+{
+	return header.number_of_faces;
+}
+
+uint32_t KtxReader::find_level(const uint32_t max_size) const
+{
+	uint32_t level = 0;
+	while (level + 1 < get_level_count() && std::max(get_width() >> level, get_height() >> level) > max_size)
+	{
+		++level;
+	}
+	return level;
+}
+
+std::unique_ptr<Image> KtxReader::get_image(const uint32_t level, const uint32_t layer, const uint32_t face) const
+{
+	if (level >= get_level_count() || layer >= get_layer_count() || face >= get_face_count())
+	{
+		throw std::out_of_range{"KTX image out of range"};
+	}
+
+	auto width  = std::max(get_width() >> level, 1u);
+	auto height = std::max(get_height() >> level, 1u);
+	auto depth  = std::max(get_depth() >> level, 1u);
+
+	auto offset     = level_offsets[level] + (layer * get_face_count() + face) * image_strides[level];
+	auto image_size = image_sizes[level];
+
+	auto block_dim = get_block_dim(header.gl_internal_format);
+	if (block_dim.x != 0)
+	{
+		auto astc = std::unique_ptr<Astc>{new Astc{storage, offset, width, height, depth, header.gl_internal_format}};
+		if (astc->get_size() != image_size)
+		{
+			throw std::runtime_error{"Error reading KTX: wrong level size"};
+		}
+		return std::move(astc);
+	}
+
+	auto channels = get_channel_count(header.gl_internal_format);
+	if (channels == 0)
+	{
+		throw std::runtime_error{"Error reading KTX: unsupported format"};
+	}
+
+	auto row_size  = size_t(width) * channels;
+	auto row_pitch = align4(row_size);
+	auto rows      = size_t(height) * depth;
+	if (row_pitch * rows != image_size)
+	{
+		throw std::runtime_error{"Error reading KTX: wrong level size"};
+	}
+
+	if (row_pitch == row_size)
+	{
+		return std::unique_ptr<Image>{new Image{storage, offset, image_size, width, height, depth, header.gl_internal_format}};
+	}
+
+	// Rows are padded, so texels have to be copied
+	auto copy = BufferPool::get_default().allocate(row_size * rows);
+	auto data = copy->get_buffer();
+	auto src  = storage->get_data() + offset;
+	for (size_t row = 0; row < rows; ++row)
+	{
+		std::memcpy(data + row * row_size, src + row * row_pitch, row_size);
+	}
+	return std::unique_ptr<Image>{new Image{std::move(copy), 0, row_size * rows, width, height, depth, header.gl_internal_format}};
+}
+
+}        // namespace atk
@@ -0,0 +1,393 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/ktx_writer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <unistd.h>
+#endif
+
+#include <gl_format.h>
+
+#include "atk/astc.h"
+#include "atk/ktx_header.h"
+#include "atk/trace.h"
+#include "atk/util.h"
+
+#ifndef GL_UNSIGNED_BYTE
+#	define GL_UNSIGNED_BYTE 0x1401
+#endif
+
+namespace atk
+{
+KtxWriter::KtxWriter(const uint32_t f, const uint32_t w, const uint32_t h, const uint32_t level_count, const uint32_t layers,
+                     const uint32_t faces) :
+    gl_format{f},
+    width{w},
+    height{h},
+    layer_count{layers},
+    face_count{faces}
+{
+	auto block_dim = get_block_dim(gl_format);
+	auto channels  = get_channel_count(gl_format);
+
+	if (block_dim.x == 0 && channels == 0)
+	{
+		throw std::runtime_error{"Cannot write KTX: unsupported format"};
+	}
+
+	if (layer_count == 0 || (face_count != 1 && face_count != 6))
+	{
+		throw std::runtime_error{"Cannot write KTX: wrong number of layers or faces"};
+	}
+
+	// Only non array cubemaps pad each face
+	bool cubemap     = face_count == 6 && layer_count == 1;
+	auto image_count = size_t(layer_count) * face_count;
+
+	size = sizeof(KtxHeader);
+
+	for (uint32_t level = 0; level < level_count; ++level)
+	{
+		auto level_width  = std::max<size_t>(width >> level, 1);
+		auto level_height = std::max<size_t>(height >> level, 1);
+
+		size_t row_pitch  = 0;
+		size_t image_size = 0;
+
+		if (block_dim.x != 0)
+		{
+			auto xblocks = (level_width + block_dim.x - 1) / block_dim.x;
+			auto yblocks = (level_height + block_dim.y - 1) / block_dim.y;
+			image_size   = xblocks * yblocks * 16;
+		}
+		else
+		{
+			row_pitch  = align4(level_width * channels);
+			image_size = row_pitch * level_height;
+		}
+
+		// Image size field precedes each level
+		size += sizeof(uint32_t);
+
+		auto image_stride = cubemap ? align4(image_size) : image_size;
+
+		row_pitches.emplace_back(row_pitch);
+		image_offsets.emplace_back(size);
+		image_sizes.emplace_back(image_size);
+		image_strides.emplace_back(image_stride);
+
+		size += align4(image_stride * image_count);
+	}
+}
+
+KtxWriter::~KtxWriter()
+{
+#if !defined(_WIN32)
+	if (data && data != buffer.data())
+	{
+		munmap(data, size);
+		std::remove(temporary_path.c_str());
+	}
+#endif
+}
+
+void KtxWriter::open()
+{
+	buffer.assign(size, 0);
+	data = buffer.data();
+
+	write_layout();
+}
+
+void KtxWriter::open(const std::string &p)
+{
+	path           = p;
+	temporary_path = get_temporary_path(path);
+
+#if defined(_WIN32)
+	// Written on close
+	open();
+#else
+	auto file = ::open(temporary_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file < 0)
+	{
+		throw std::runtime_error{"Cannot create [" + path + "]"};
+	}
+
+#if defined(__APPLE__)
+	// No posix_fallocate, the file stays sparse
+	auto allocated = ftruncate(file, size) == 0;
+#else
+	// Blocks are reserved up front, otherwise a full disk would raise SIGBUS on the first
+	// write to an unbacked page of the mapping instead of failing this file
+	auto allocated = posix_fallocate(file, 0, size) == 0;
+#endif
+
+	if (!allocated)
+	{
+		::close(file);
+		std::remove(temporary_path.c_str());
+		throw std::runtime_error{"Cannot allocate [" + path + "]"};
+	}
+
+	auto mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	::close(file);
+
+	if (mapping == MAP_FAILED)
+	{
+		std::remove(temporary_path.c_str());
+		throw std::runtime_error{"Cannot map [" + path + "]"};
+	}
+
+	data = reinterpret_cast<uint8_t *>(mapping);
+
+	write_layout();
+#endif
+}
+
+void KtxWriter::close()
+{
+	if (path.empty())
+	{
+		return;        // in memory
+	}
+
+	TraceScope trace{"ktx-save", -1, size};
+
+#if defined(_WIN32)
+	std::ofstream file{temporary_path, std::ios::binary};
+	file.write(reinterpret_cast<const char *>(data), size);
+	file.close();
+
+	if (!file)
+	{
+		std::remove(temporary_path.c_str());
+		throw std::runtime_error{"Cannot write [" + path + "]"};
+	}
+	data = nullptr;
+	buffer.clear();
+#else
+	munmap(data, size);
+	data = nullptr;
+#endif
+
+	// Replace existing file in one step
+	if (std::rename(temporary_path.c_str(), path.c_str()) != 0)
+	{
+		std::remove(temporary_path.c_str());
+		throw std::runtime_error{"Cannot write [" + path + "]"};
+	}
+}
+
+void KtxWriter::write_layout()
+{
+	auto block_dim = get_block_dim(gl_format);
+	auto channels  = get_channel_count(gl_format);
+
+	KtxHeader header = {};
+	std::copy(std::begin(KTX_IDENTIFIER), std::end(KTX_IDENTIFIER), header.identifier);
+	header.endianness         = KTX_ENDIANNESS;
+	header.gl_internal_format = gl_format;
+	header.gl_type_size       = 1;
+	header.pixel_width        = width;
+	header.pixel_height       = height;
+	header.number_of_faces    = face_count;
+
+	// A single layer is written as a non array texture
+	header.number_of_array_elements = layer_count > 1 ? layer_count : 0;
+
+	header.number_of_mipmap_levels = static_cast<uint32_t>(image_sizes.size());
+
+	if (block_dim.x != 0)
+	{
+		// Compressed formats have no type nor format
+		header.gl_base_internal_format = GL_RGBA;
+	}
+	else
+	{
+		header.gl_type                 = GL_UNSIGNED_BYTE;
+		header.gl_format               = channels == 4 ? GL_RGBA : GL_RGB;
+		header.gl_base_internal_format = header.gl_format;
+	}
+
+	std::memcpy(data, &header, sizeof(header));
+
+	// Non array cubemaps give the size of a single face, other textures the size of the whole level
+	bool cubemap     = face_count == 6 && layer_count == 1;
+	auto image_count = size_t(layer_count) * face_count;
+
+	for (size_t level = 0; level < image_sizes.size(); ++level)
+	{
+		auto image_size = static_cast<uint32_t>(cubemap ? image_sizes[level] : image_sizes[level] * image_count);
+		std::memcpy(data + image_offsets[level] - sizeof(uint32_t), &image_size, sizeof(image_size));
+	}
+}
+
+uint8_t *KtxWriter::get_image_data(const uint32_t level, const uint32_t layer, const uint32_t face)
+{
+	assert(data && "KTX writer is not open");
+	if (layer >= layer_count || face >= face_count)
+	{
+		throw std::out_of_range{"KTX image out of range"};
+	}
+	return data + image_offsets.at(level) + (layer * face_count + face) * image_strides[level];
+}
+
+uint32_t KtxWriter::get_level_count() const
+{
+	return static_cast<uint32_t>(image_sizes.size());
+}
+
+uint32_t KtxWriter::get_layer_count() const
+{
+	return layer_count;
+}
+
+uint32_t KtxWriter::get_face_count() const
+{
+	return face_count;
+}
+
+size_t KtxWriter::get_image_size(const uint32_t level) const
+{
+	return image_sizes.at(level);
+}
+
+void KtxWriter::set_image(const uint32_t level, Image &image)
+{
+	set_image(level, 0, 0, image);
+}
+
+void KtxWriter::set_image(const uint32_t level, const uint32_t layer, const uint32_t face, Image &image)
+{
+	TraceScope trace{"ktx-copy", int32_t(level), image.get_size()};
+
+	auto dst = get_image_data(level, layer, face);
+	auto src = image.get_data();
+
+	if (image.get_gl_format() != gl_format)
+	{
+		throw std::runtime_error{"Cannot write KTX: level format differs from texture format"};
+	}
+
+	auto row_pitch = row_pitches[level];
+	if (row_pitch == 0)
+	{
+		// Compressed blocks need no padding
+		if (image.get_size() != image_sizes[level])
+		{
+			throw std::runtime_error{"Cannot write KTX: wrong level size"};
+		}
+		std::memcpy(dst, src, image.get_size());
+		return;
+	}
+
+	auto row_size = size_t(image.get_width()) * get_channel_count(gl_format);
+	if (row_size * image.get_height() != image.get_size() || row_pitch * image.get_height() != image_sizes[level])
+	{
+		throw std::runtime_error{"Cannot write KTX: wrong level size"};
+	}
+
+	for (uint32_t y = 0; y < image.get_height(); ++y)
+	{
+		std::memcpy(dst + y * row_pitch, src + y * row_size, row_size);
+	}
+}
+
+const uint8_t *KtxWriter::get_data() const
+{
+	return data;
+}
+
+size_t KtxWriter::get_size() const
+{
+	return size;
+}
+
+void write_ktx(Texture &texture, const std::string &path)
+{
+	auto &image = texture.get_image();
+
+	KtxWriter writer{image.get_gl_format(), image.get_width(), image.get_height(), static_cast<uint32_t>(texture.get_levels()),
+	                 texture.get_layer_count(), texture.get_face_count()};
+	writer.open(path);
+
+	for (uint32_t level = 0; level < texture.get_levels(); ++level)
+	{
+		for (uint32_t layer = 0; layer < texture.get_layer_count(); ++layer)
+		{
+			for (uint32_t face = 0; face < texture.get_face_count(); ++face)
+			{
+				writer.set_image(level, layer, face, texture.get_level(level, layer, face));
+			}
+		}
+	}
+
+	writer.close();
+}
+
+void write_astc_ktx(Texture &texture, const std::string &path, const EncodeOptions &options)
+{
+	auto gl_format = get_astc_gl_format(options.block_dim, options.srgb);
+	if (gl_format == 0)
+	{
+		throw std::runtime_error{"Invalid astc block footprint"};
+	}
+
+	auto &base = texture.get_image();
+
+	KtxWriter writer{gl_format, base.get_width(), base.get_height(), static_cast<uint32_t>(texture.get_levels()),
+	                 texture.get_layer_count(), texture.get_face_count()};
+	writer.open(path);
+
+	std::vector<Image *>   images;
+	std::vector<uint8_t *> outputs;
+
+	for (uint32_t level = 0; level < texture.get_levels(); ++level)
+	{
+		for (uint32_t layer = 0; layer < texture.get_layer_count(); ++layer)
+		{
+			for (uint32_t face = 0; face < texture.get_face_count(); ++face)
+			{
+				auto &image = texture.get_level(level, layer, face);
+				image.convert(Format::RGBA);
+				images.emplace_back(&image);
+				outputs.emplace_back(writer.get_image_data(level, layer, face));
+			}
+		}
+	}
+
+	// Tasks are made of blocks whatever their image, so the schedule scales with the total block count
+	Astc::encode_to(images, outputs, options);
+
+	writer.close();
+}
+
+}        // namespace atk
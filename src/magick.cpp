@@ -19,6 +19,7 @@
  */
 
 #include <atk/magick.h>
+#include <atk/trace.h>
 
 namespace atk
 {
@@ -34,7 +35,15 @@ MagickImage::MagickImage(Magick::Image &&i) :
 	set_width(geometry.width());
 	set_height(geometry.height());
 
-	update_data();
+	set_format(image.alpha() ? Format::RGBA : Format::RGB);
+}
+
+MagickImage::MagickImage(MagickImage &&other) :
+    Image{std::move(other)},
+    image{std::move(other.image)},
+    format{other.format},
+    pixels{std::move(other.pixels)}
+{
 }
 
 Magick::Image &MagickImage::get_image()
@@ -42,87 +51,43 @@ Magick::Image &MagickImage::get_image()
 	return image;
 }
 
-void MagickImage::update_data()
+void MagickImage::set_format(const Format f)
 {
-	image.write(&blob);
-	set_size(blob.length());
+	format = f;
+	set_size(size_t(get_width()) * get_height() * (format == Format::RGBA ? 4 : 3));
+
+	std::lock_guard<std::mutex> lock{pixels_mutex};
+	pixels.reset();
 }
 
 /// @brief Converts image format
 /// @param format Format to apply
-void MagickImage::convert(Format format)
+void MagickImage::convert(const Format f)
 {
 	// Ensure image has a colorspace
 	assert(image.colorSpace() != Magick::ColorspaceType::UndefinedColorspace);
 
-	switch (format)
+	if (f != Format::RGB && f != Format::RGBA)
 	{
-		case Format::RGB:
-		{
-			// Convert to raw RGB
-			image.depth(8);
-			image.magick("RGB");
-			auto channels = image.channels();
-			assert(channels == 3);
-			break;
-		}
-		case Format::RGBA:
-		{
-			// Convert to raw RGBA
-			image.alphaChannel(Magick::ActivateAlphaChannel);
-			image.depth(8);
-			image.magick("RGBA");
-			auto channels = image.channels();
-			assert(channels == 4);
-			break;
-		}
-		default:
-		{
-			throw std::runtime_error{"Format not supported"};
-		}
+		throw std::runtime_error{"Format not supported"};
 	}
 
-	update_data();
-}
-
-bool has_alpha(const Magick::ImageType type)
-{
-	return type == Magick::ImageType::TrueColorAlphaType ||
-	       type == Magick::ImageType::PaletteAlphaType ||
-	       type == Magick::ImageType::GrayscaleAlphaType ||
-	       type == Magick::ImageType::ColorSeparationAlphaType ||
-	       type == Magick::ImageType::PaletteBilevelAlphaType;
+	if (f != format)
+	{
+		set_format(f);
+	}
 }
 
 uint32_t MagickImage::get_gl_format()
 {
-	auto type = image.type();
+	auto alpha = format == Format::RGBA;
 
 	switch (image.colorSpace())
 	{
 		case Magick::ColorspaceType::sRGBColorspace:
-			if (has_alpha(type))
-			{
-				convert(Format::RGBA);
-				return GL_SRGB8_ALPHA8;
-			}
-			else
-			{
-				convert(Format::RGB);
-				return GL_SRGB8;
-			}
-			break;
+			return alpha ? GL_SRGB8_ALPHA8 : GL_SRGB8;
 		case Magick::ColorspaceType::RGBColorspace:
-			if (has_alpha(type))
-			{
-				convert(Format::RGBA);
-				return GL_RGBA;
-			}
-			else
-			{
-				convert(Format::RGB);
-				return GL_RGB;
-			}
+			return alpha ? GL_RGBA : GL_RGB;
 		default:
 			break;
 	}
@@ -142,12 +107,31 @@ std::unique_ptr<Image> MagickImage::resize(const uint32_t w, const uint32_t h)
 	resized_image.resize(resized_geometry);
 
 	auto ret_image = new MagickImage{std::move(resized_image)};
+	ret_image->convert(format);
 	return std::unique_ptr<Image>{ret_image};
 }
 
 const uint8_t *MagickImage::get_data() const
 {
-	return reinterpret_cast<const uint8_t *>(blob.data());
+	std::lock_guard<std::mutex> lock{pixels_mutex};
+
+	if (!pixels)
+	{
+		TraceScope trace{"export", -1, get_size()};
+		pixels = BufferPool::get_default().allocate(get_size());
+		export_rows(0, get_height(), pixels->get_buffer());
+	}
+
+	return pixels->get_data();
+}
+
+void MagickImage::export_rows(const uint32_t first_row, const uint32_t row_count, uint8_t *rows) const
+{
+	assert(first_row + row_count <= get_height() && "Rows exceed the image");
+
+	// Exporting pixels reads the image without modifying it
+	auto &source = const_cast<Magick::Image &>(image);
+	source.write(0, first_row, get_width(), row_count, format == Format::RGBA ? "RGBA" : "RGB", Magick::CharPixel, rows);
 }
 
 void MagickImage::store(const std::string &path)
@@ -1,11 +1,30 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
 
 #include "atk/astc.h"
+#include "atk/astc_cache.h"
+#include "atk/bounded_queue.h"
+#include "atk/buffer_pool.h"
+#include "atk/footprint.h"
 #include "atk/ktx.h"
+#include "atk/ktx_reader.h"
+#include "atk/ktx_writer.h"
 #include "atk/magick.h"
+#include "atk/manifest.h"
+#include "atk/metrics.h"
+#include "atk/server.h"
+#include "atk/strip_encoder.h"
 #include "atk/texture.h"
+#include "atk/thread_pool.h"
+#include "atk/trace.h"
 #include "atk/util.h"
 
 namespace atk
@@ -13,37 +32,155 @@ namespace atk
 class Config
 {
   public:
-	Config(const int argc, const char **argv);
+	/// @param[in] args Command line arguments, program name first
+	Config(const std::vector<std::string> &args);
 
 	/// Whether to generate mipmaps
 	bool mipmaps = false;
 
+	/// How to generate mipmaps
+	MipmapGenerator mipmap_generator = MipmapGenerator::Native;
+
 	/// Whether to convert
 	bool convert = false;
 
 	/// Target format to convert
 	std::string target_format = {};
 
-	/// Input image path
-	std::string input_image = {};
+	/// Encoder parameters
+	EncodeOptions encode_options = {};
+
+	/// PSNR in dB the footprint of each image is picked for, zero to use the footprint of the options
+	double target_psnr = 0.0;
+
+	/// Cache of encoded levels, none when null
+	std::unique_ptr<AstcCache> cache = nullptr;
+
+	/// Counters of the encoder
+	EncodeStats encode_stats;
+
+	/// How outputs were built, none when null. Shared by the jobs of a server using the same path
+	std::shared_ptr<Manifest> manifest = nullptr;
+
+	/// Block rows of the strips to encode, zero to encode whole levels
+	uint32_t strip_block_rows = 0;
+
+	/// Number of worker threads, zero to use every available core
+	uint32_t thread_count = 0;
+
+	/// Whether to measure the levels written against their source
+	bool verify = false;
+
+	/// JSON file with the time spent by each stage, none when empty
+	std::string stats_path = {};
+
+	/// Chrome trace file to write, none when empty
+	std::string trace_path = {};
+
+	/// Socket to serve jobs on, "-" for stdin, none when empty
+	std::string server_path = {};
+
+	/// Array layers of each texture
+	uint32_t layer_count = 1;
+
+	/// Faces of each texture, six for cubemaps
+	uint32_t face_count = 1;
+
+	/// Where progress messages go
+	std::ostream *log = &std::cout;
+
+	/// Input image paths
+	std::vector<std::string> input_images = {};
+
+	/// @return Every option affecting the outputs, as a single string
+	std::string get_options() const;
+
+	/// @return The number of input images packed into each texture, one for each layer and face
+	size_t get_texture_image_count() const
+	{
+		return size_t(layer_count) * face_count;
+	}
+
+	/// @return The number of textures, each one made of consecutive input images
+	size_t get_texture_count() const
+	{
+		return input_images.size() / get_texture_image_count();
+	}
+
+	/// @return The first input image of a texture, which names it
+	const std::string &get_texture_input(size_t texture) const
+	{
+		return input_images[texture * get_texture_image_count()];
+	}
 
   private:
 	bool is_option(const std::string &arg);
+
+	/// @brief Adds every non-empty line of a stream as an input image
+	void read_input_list(std::istream &is);
 };
 
 bool Config::is_option(const std::string &arg)
 {
-	return arg.at(0) == '-';
+	return arg.size() > 1 && arg.at(0) == '-';
 }
 
-Config::Config(const int argc, const char **argv)
+void Config::read_input_list(std::istream &is)
 {
-	std::vector<std::string> args{argv, argv + argc};
+	std::string line;
+	while (std::getline(is, line))
+	{
+		// Strip carriage return of files written on Windows
+		if (!line.empty() && line.back() == '\r')
+		{
+			line.pop_back();
+		}
 
-	for (size_t i = 0; i < argc; ++i)
+		if (!line.empty())
+		{
+			input_images.emplace_back(line);
+		}
+	}
+}
+
+/// @return The integer written in an argument, which must hold nothing else, so that "8x" is not read as 8
+long parse_integer(const std::string &arg)
+{
+	size_t end   = 0;
+	long   value = 0;
+	try
+	{
+		value = std::stol(arg, &end);
+	}
+	catch (const std::logic_error &)
+	{
+		end = 0;
+	}
+
+	if (end == 0 || end != arg.size())
+	{
+		throw std::runtime_error{"Invalid integer [" + arg + "]"};
+	}
+	return value;
+}
+
+Config::Config(const std::vector<std::string> &args)
+{
+	std::string cache_directory = {};
+	uint64_t    cache_size      = 1024;
+	std::string manifest_path   = {};
+
+	// Skip program name
+	for (size_t i = 1; i < args.size(); ++i)
 	{
 		auto &arg = args[i];
 
+		// Like empty lines of an input list, such as an unset variable quoted by a script
+		if (arg.empty())
+		{
+			continue;
+		}
+
 		if (is_option(arg))
 		{
 			const auto option = arg.substr(1);
@@ -54,19 +191,691 @@ Config::Config(const int argc, const char **argv)
 				mipmaps = true;
 			}
 
+			// Mipmaps resized by ImageMagick
+			if (option == "magick-mipmaps")
+			{
+				mipmaps          = true;
+				mipmap_generator = MipmapGenerator::Magick;
+			}
+
 			// Compress
-			if (option == "c")
+			if (option == "c" && i + 1 < args.size())
 			{
 				convert = true;
 				// Consume next argument
 				target_format = args[++i];
 			}
+
+			// Encoder preset
+			if (option == "preset" && i + 1 < args.size())
+			{
+				// Consume next argument
+				encode_options.preset = get_preset(args[++i]);
+			}
+
+			// Astc block footprint
+			if (option == "block" && i + 1 < args.size())
+			{
+				// Consume next argument
+				encode_options.block_dim = parse_block_dim(args[++i]);
+			}
+
+			// Quality target
+			if (option == "target-psnr" && i + 1 < args.size())
+			{
+				// Consume next argument
+				target_psnr = std::stod(args[++i]);
+			}
+
+			// Linear color space
+			if (option == "linear")
+			{
+				encode_options.srgb = false;
+			}
+
+			// Cache directory
+			if (option == "cache" && i + 1 < args.size())
+			{
+				// Consume next argument
+				cache_directory = args[++i];
+			}
+
+			// Cache size in MiB
+			if (option == "cache-size" && i + 1 < args.size())
+			{
+				// Consume next argument
+				cache_size = std::stoull(args[++i]);
+			}
+
+			// Manifest
+			if (option == "manifest" && i + 1 < args.size())
+			{
+				// Consume next argument
+				manifest_path = args[++i];
+			}
+
+			// Strips
+			if (option == "strips" && i + 1 < args.size())
+			{
+				// Consume next argument
+				strip_block_rows = static_cast<uint32_t>(std::stoul(args[++i]));
+			}
+
+			// Threads
+			if (option == "threads" && i + 1 < args.size())
+			{
+				// Consume next argument, parsed as signed so that a negative count does not wrap
+				auto count     = parse_integer(args[++i]);
+				auto max_count = std::max(std::thread::hardware_concurrency(), get_available_thread_count());
+				if (count < 0 || count > static_cast<long>(max_count))
+				{
+					throw std::runtime_error{"Invalid thread count [" + args[i] + "], expected 0 to " + std::to_string(max_count)};
+				}
+				thread_count = static_cast<uint32_t>(count);
+			}
+
+			// Verify outputs
+			if (option == "verify")
+			{
+				verify = true;
+			}
+
+			// Stage statistics
+			if (option == "stats" && i + 1 < args.size())
+			{
+				// Consume next argument
+				stats_path = args[++i];
+			}
+
+			// Chrome trace
+			if (option == "trace" && i + 1 < args.size())
+			{
+				// Consume next argument
+				trace_path = args[++i];
+			}
+
+			// Server
+			if (option == "server" && i + 1 < args.size())
+			{
+				// Consume next argument
+				server_path = args[++i];
+			}
+
+			// Cubemap faces
+			if (option == "cubemap")
+			{
+				face_count = 6;
+			}
+
+			// Array layers
+			if (option == "array" && i + 1 < args.size())
+			{
+				// Consume next argument
+				layer_count = static_cast<uint32_t>(std::stoul(args[++i]));
+			}
+		}
+		else if (arg == "-")        // input list from stdin
+		{
+			read_input_list(std::cin);
+		}
+		else if (arg.at(0) == '@')        // input list from response file
+		{
+			std::ifstream list{arg.substr(1)};
+			if (!list)
+			{
+				throw std::runtime_error{"Cannot open input list [" + arg.substr(1) + "]"};
+			}
+			read_input_list(list);
 		}
 		else        // it is not an option
 		{
-			input_image = arg;
+			input_images.emplace_back(arg);
 		}
 	}
+
+	encode_options.stats = &encode_stats;
+
+	if (strip_block_rows > 0 && mipmap_generator == MipmapGenerator::Magick)
+	{
+		throw std::runtime_error{"Strips cannot be resized by ImageMagick"};
+	}
+
+	if (layer_count == 0)
+	{
+		throw std::runtime_error{"Arrays need at least one layer"};
+	}
+
+	if (strip_block_rows > 0 && get_texture_image_count() > 1)
+	{
+		throw std::runtime_error{"Strips cannot be used with cubemaps or arrays"};
+	}
+
+	// Events would pile up until the server stops, as they are only written at exit
+	if (!server_path.empty() && (!stats_path.empty() || !trace_path.empty()))
+	{
+		throw std::runtime_error{"Stats and traces cannot be recorded by a server"};
+	}
+
+	if (input_images.size() % get_texture_image_count() != 0)
+	{
+		throw std::runtime_error{std::to_string(input_images.size()) + " images cannot be packed into textures of " +
+		                         std::to_string(get_texture_image_count()) + " images"};
+	}
+
+	if (!cache_directory.empty())
+	{
+		cache.reset(new AstcCache{cache_directory, cache_size << 20});
+		encode_options.cache = cache.get();
+	}
+
+	if (!manifest_path.empty())
+	{
+		manifest = Manifest::get_shared(manifest_path);
+	}
+}
+
+std::string Config::get_options() const
+{
+	std::ostringstream options;
+
+	options << "mipmaps=" << (mipmaps ? (mipmap_generator == MipmapGenerator::Native ? "native" : "magick") : "none");
+
+	if (layer_count > 1)
+	{
+		options << " layers=" << layer_count;
+	}
+
+	if (face_count > 1)
+	{
+		options << " faces=" << face_count;
+	}
+
+	if (convert)
+	{
+		auto &block_dim = encode_options.block_dim;
+		options << " format=" << target_format
+		        << " preset=" << get_name(encode_options.preset);
+		if (target_psnr > 0.0)
+		{
+			options << " target-psnr=" << target_psnr;
+		}
+		else
+		{
+			options << " block=" << int(block_dim.x) << "x" << int(block_dim.y) << "x" << int(block_dim.z);
+		}
+		options << " srgb=" << encode_options.srgb;
+	}
+
+	return options.str();
+}
+
+/// @return The KTX file written for an input image, in the working directory
+std::string get_ktx_name(const std::string &image_path)
+{
+	return get_basename_no_extension(image_path) + ".ktx";
+}
+
+/// @brief Fails the textures whose KTX file is the one of a previous texture, such as a/rock.png
+///        and b/rock.png, so that no output is written twice
+/// @param[in] config Conversion options
+/// @param[out] errors Error message of each texture
+void fail_duplicate_outputs(const Config &config, std::vector<std::string> &errors)
+{
+	std::map<std::string, size_t> outputs;
+	for (size_t i = 0; i < config.get_texture_count(); ++i)
+	{
+		auto output = outputs.emplace(get_ktx_name(config.get_texture_input(i)), i);
+		if (!output.second)
+		{
+			errors[i] = "Output [" + output.first->first + "] is already written for [" + config.get_texture_input(output.first->second) + "]";
+		}
+	}
+}
+
+/// @brief Reads back each level of a KTX file, decoding compressed ones, and measures it
+///        against the level it was made from
+/// @param[in] texture Levels the KTX file was made from
+/// @param[in] ktx_name Path of the KTX file
+/// @return A line for each level of each layer and face with its quality
+std::string verify_ktx(Texture &texture, const std::string &ktx_name)
+{
+	TraceScope trace{"verify"};
+
+	KtxReader reader{ktx_name};
+	if (reader.get_level_count() != texture.get_levels() || reader.get_layer_count() != texture.get_layer_count() ||
+	    reader.get_face_count() != texture.get_face_count())
+	{
+		throw std::runtime_error{"Cannot verify [" + ktx_name + "]: wrong level, layer or face count"};
+	}
+
+	std::ostringstream report;
+	for (uint32_t layer = 0; layer < texture.get_layer_count(); ++layer)
+	{
+		for (uint32_t face = 0; face < texture.get_face_count(); ++face)
+		{
+			for (uint32_t level = 0; level < texture.get_levels(); ++level)
+			{
+				auto &source = texture.get_level(level, layer, face);
+				auto  image  = reader.get_image(level, layer, face);
+
+				Metrics metrics;
+				if (auto astc = dynamic_cast<Astc *>(image.get()))
+				{
+					// Decoded levels are always RGBA
+					source.convert(Format::RGBA);
+					metrics = measure(source, astc->decode());
+				}
+				else
+				{
+					metrics = measure(source, *image);
+				}
+
+				report << "Verified [" << ktx_name << "]";
+				if (texture.get_layer_count() > 1)
+				{
+					report << " layer " << layer;
+				}
+				if (texture.get_face_count() > 1)
+				{
+					report << " face " << face;
+				}
+				report << " level " << level << ": PSNR " << metrics.get_psnr() << " dB, SSIM " << metrics.get_ssim()
+				       << ", max error " << int(metrics.get_max_error()) << "\n";
+			}
+		}
+	}
+
+	return report.str();
+}
+
+/// @brief Picks the footprint of an image when there is a quality target
+/// @return The encoder parameters for the image
+EncodeOptions get_encode_options(const Config &config, Image &image, const std::string &ktx_name)
+{
+	auto options = config.encode_options;
+	if (config.target_psnr > 0.0)
+	{
+		auto choice       = select_footprint(image, config.target_psnr, options);
+		options.block_dim = choice.block_dim;
+
+		std::ostringstream report;
+		report << "Footprint [" << ktx_name << "] " << int(choice.block_dim.x) << "x" << int(choice.block_dim.y) << ": PSNR "
+		       << choice.psnr << " dB" << (choice.met ? "" : ", below target") << "\n";
+		*config.log << report.str();
+	}
+	return options;
+}
+
+/// @brief File moving through the stages of the conversion pipeline
+struct Job
+{
+	/// Index of the texture
+	size_t index = 0;
+
+	std::string ktx_name;
+
+	/// How the KTX file is built, for the manifest
+	Manifest::Entry entry;
+
+	/// Levels converted in memory
+	std::unique_ptr<Texture> texture;
+
+	/// Image encoded in strips, its pixels are never exported whole
+	std::unique_ptr<MagickImage> image;
+};
+
+/// @brief Loading stage: decodes the images of a texture and exports their pixels
+/// @param[in] config Conversion options
+/// @param[in] index Index of the texture
+/// @return The job of the texture, null when its KTX file is already up to date
+std::unique_ptr<Job> load_image(const Config &config, const size_t index)
+{
+	auto &image_path = config.get_texture_input(index);
+
+	auto first_input = config.input_images.begin() + index * config.get_texture_image_count();
+	auto inputs      = std::vector<std::string>(first_input, first_input + config.get_texture_image_count());
+
+	std::unique_ptr<Job> job{new Job};
+	job->index    = index;
+	job->ktx_name = get_ktx_name(image_path);
+
+	TraceFile trace_file{image_path};
+
+	if (config.manifest)
+	{
+		auto &entry = job->entry;
+		for (auto &input : inputs)
+		{
+			// Layers and faces are listed in order, separated by a semicolon
+			entry.input += (entry.input.empty() ? "" : ";") + input;
+			entry.input_hash += (entry.input_hash.empty() ? "" : ";") + Manifest::hash_file(input);
+		}
+		entry.options = config.get_options();
+		entry.version = get_version();
+
+		if (config.manifest->is_up_to_date(job->ktx_name, entry))
+		{
+			*config.log << "Up to date [" << job->ktx_name << "]\n";
+			return nullptr;
+		}
+	}
+
+	TraceScope trace{"load"};
+
+	std::vector<std::unique_ptr<Image>> images;
+	for (auto &input : inputs)
+	{
+		std::unique_ptr<MagickImage> image{new MagickImage{input}};
+
+		if (config.convert && config.strip_block_rows > 0)
+		{
+			// Rows are exported a strip at a time while encoding, strips have a single image
+			job->image = std::move(image);
+			return job;
+		}
+
+		// Exported now, so that later stages only compute
+		if (config.convert)
+		{
+			image->convert(Format::RGBA);
+		}
+		image->get_data();
+
+		images.emplace_back(std::move(image));
+	}
+
+	job->texture.reset(new Texture{std::move(images), config.layer_count, config.face_count});
+	return job;
+}
+
+/// @brief Mipmap stage: generates the levels of a texture converted in memory
+void generate_levels(const Config &config, Job &job)
+{
+	if (config.mipmaps && job.texture)
+	{
+		TraceFile trace_file{config.get_texture_input(job.index)};
+		job.texture->generate_mipmap_chain(config.mipmap_generator);
+	}
+}
+
+/// @brief Writing stage: encodes the levels and writes the KTX file
+void write_levels(const Config &config, Job &job)
+{
+	auto &ktx_name = job.ktx_name;
+
+	TraceFile trace_file{config.get_texture_input(job.index)};
+
+	if (job.image)
+	{
+		// Neither the levels nor their pixels are kept whole
+		auto options = get_encode_options(config, *job.image, ktx_name);
+		write_astc_ktx_strips(*job.image, ktx_name, config.mipmaps, options, config.strip_block_rows);
+
+		if (config.verify)
+		{
+			// Levels are made again, the native generator filters them as the strips did
+			job.texture.reset(new Texture{std::move(job.image)});
+			if (config.mipmaps)
+			{
+				job.texture->generate_mipmap_chain(MipmapGenerator::Native);
+			}
+			*config.log << verify_ktx(*job.texture, ktx_name);
+		}
+	}
+	else
+	{
+		if (config.convert)
+		{
+			// Levels are encoded straight into the file
+			write_astc_ktx(*job.texture, ktx_name, get_encode_options(config, job.texture->get_image(), ktx_name));
+		}
+		else
+		{
+			write_ktx(*job.texture, ktx_name);
+		}
+
+		if (config.verify)
+		{
+			*config.log << verify_ktx(*job.texture, ktx_name);
+		}
+	}
+
+	*config.log << "Saved [" << ktx_name << "]\n";
+
+	if (config.manifest)
+	{
+		config.manifest->set(ktx_name, job.entry);
+	}
+}
+
+/// @brief Converts every input image and packs each texture into a KTX file named after its first image.
+///        Loading, mipmap generation and writing run in a pipeline, each stage on its own
+///        thread with the thread pool helping the stages which are parallel, so that loading
+///        a file overlaps the mipmaps of the previous one and the encoding of the one before.
+///        Stages are connected by bounded queues, therefore only a few files are in memory
+///        however many there are
+/// @param[in] config Conversion options
+/// @param[out] errors Error message of each texture, empty when it was converted
+/// @return The number of KTX files which were already up to date
+size_t convert_images(const Config &config, std::vector<std::string> &errors)
+{
+	// Decoding an image runs on a single thread, so two files are loaded at once
+	const size_t loader_count = 2;
+
+	// Files waiting between two stages
+	const size_t queue_capacity = 1;
+
+	auto texture_count = config.get_texture_count();
+
+	BoundedQueue<std::unique_ptr<Job>> loaded{queue_capacity};
+	BoundedQueue<std::unique_ptr<Job>> leveled{queue_capacity};
+
+	std::atomic<size_t> next_texture{0};
+	std::atomic<size_t> up_to_date_count{0};
+
+	auto fail = [&errors](const size_t index, const std::exception &e) {
+		errors[index] = e.what();
+		if (errors[index].empty())
+		{
+			errors[index] = "Unknown error";
+		}
+	};
+
+	auto active_loaders = std::min(loader_count, texture_count);
+
+	std::atomic<size_t> running_loaders{active_loaders};
+
+	fail_duplicate_outputs(config, errors);
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < active_loaders; ++i)
+	{
+		threads.emplace_back([&] {
+			size_t index;
+			while ((index = next_texture++) < texture_count)
+			{
+				if (!errors[index].empty())
+				{
+					continue;
+				}
+
+				try
+				{
+					auto job = load_image(config, index);
+					if (!job)
+					{
+						++up_to_date_count;
+						continue;
+					}
+					loaded.push(std::move(job));
+				}
+				catch (const std::exception &e)
+				{
+					fail(index, e);
+				}
+			}
+
+			// The last loader tells the next stage there is nothing more to come
+			if (--running_loaders == 0)
+			{
+				loaded.close();
+			}
+		});
+	}
+
+	threads.emplace_back([&] {
+		std::unique_ptr<Job> job;
+		while (loaded.pop(job))
+		{
+			try
+			{
+				generate_levels(config, *job);
+				leveled.push(std::move(job));
+			}
+			catch (const std::exception &e)
+			{
+				fail(job->index, e);
+			}
+		}
+		leveled.close();
+	});
+
+	// Writing runs on the calling thread
+	std::unique_ptr<Job> job;
+	while (leveled.pop(job))
+	{
+		try
+		{
+			write_levels(config, *job);
+		}
+		catch (const std::exception &e)
+		{
+			fail(job->index, e);
+		}
+
+		// Memory of the file is released before waiting for the next one
+		job.reset();
+	}
+
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+
+	return up_to_date_count;
+}
+
+/// @brief Runs a job of the server, whose arguments are those of the command line
+///        plus -bytes, which sends the KTX files back after the answer
+/// @param[in] args Arguments of the job
+/// @return The outputs and errors of the job
+ServerResponse run_job(const std::vector<std::string> &args)
+{
+	std::vector<std::string> job_args{"ktx-creator"};
+
+	bool send_bytes = false;
+	for (auto &arg : args)
+	{
+		if (arg == "-bytes")
+		{
+			send_bytes = true;
+		}
+		else if (arg == "-")
+		{
+			throw std::runtime_error{"Input lists from stdin are not supported by jobs"};
+		}
+		else
+		{
+			job_args.emplace_back(arg);
+		}
+	}
+
+	Config config{job_args};
+
+	if (!config.stats_path.empty() || !config.trace_path.empty())
+	{
+		throw std::runtime_error{"Stats and traces are not supported by jobs"};
+	}
+
+	// Answers may use stdout
+	config.log = &std::clog;
+
+	if (config.convert && config.target_format != "astc")
+	{
+		throw std::runtime_error{"Format not supported: " + config.target_format};
+	}
+
+	auto &inputs = config.input_images;
+	if (inputs.empty())
+	{
+		throw std::runtime_error{"No input image"};
+	}
+
+	std::vector<std::string> errors(config.get_texture_count());
+	auto                     up_to_date_count = convert_images(config, errors);
+
+	if (config.manifest)
+	{
+		config.manifest->save();
+	}
+
+	ServerResponse response;
+
+	std::ostringstream outputs;
+	std::ostringstream failures;
+	for (size_t i = 0; i < errors.size(); ++i)
+	{
+		auto &input = config.get_texture_input(i);
+		if (errors[i].empty())
+		{
+			auto ktx_name = get_ktx_name(input);
+			outputs << (response.files.empty() ? "" : ", ") << quote_json(ktx_name);
+			response.files.emplace_back(ktx_name);
+		}
+		else
+		{
+			failures << (response.ok ? "" : ", ") << "{\"input\": " << quote_json(input) << ", \"error\": " << quote_json(errors[i])
+			         << "}";
+			response.ok = false;
+		}
+	}
+
+	response.fields = "\"outputs\": [" + outputs.str() + "], \"errors\": [" + failures.str() +
+	                  "], \"up_to_date\": " + std::to_string(up_to_date_count) +
+	                  ", \"blocks\": " + std::to_string(config.encode_stats.block_count);
+
+	if (!send_bytes)
+	{
+		response.files.clear();
+	}
+
+	return response;
+}
+
+/// @brief Serves jobs until a client asks for a shutdown, or stdin ends
+int serve_jobs(const Config &config)
+{
+	Server server{run_job};
+
+	try
+	{
+		if (config.server_path == "-")
+		{
+			server.serve(std::cin, std::cout);
+		}
+		else
+		{
+			std::clog << "Listening on [" << config.server_path << "]\n";
+			server.listen(config.server_path);
+		}
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "[ERROR] " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
 }
 
 }        // namespace atk
@@ -75,47 +884,139 @@ int main(const int argc, const char **argv)
 {
 	if (argc < 2)
 	{
-		std::cerr << "Usage: to-ktx [-mipmaps] [-c astc] texture.png\n";
+		std::cerr << "Usage: ktx-creator [-mipmaps|-magick-mipmaps] [-c astc] [-preset fastest|fast|medium|thorough|exhaustive] [-block 8x8|-target-psnr dB] [-linear] [-cache dir] [-cache-size MiB] [-manifest file] [-strips n] [-threads n] [-verify] [-stats file.json] [-trace file.json] [-server socket|-] [-cubemap] [-array n] <texture.png...|@list.txt|->\n";
 		return EXIT_FAILURE;
 	}
 
-	const atk::Config config{argc, argv};
+	Magick::InitializeMagick(*argv);
 
-	const std::string           image_path{config.input_image};
-	std::unique_ptr<atk::Image> image{new atk::MagickImage{image_path}};
-	atk::Texture                texture{std::move(image)};
+	std::unique_ptr<atk::Config> config;
+	try
+	{
+		config.reset(new atk::Config{std::vector<std::string>{argv, argv + argc}});
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "[ERROR] Invalid arguments: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	atk::ThreadPool::set_default_thread_count(config->thread_count);
 
-	if (config.mipmaps)
+	if (!config->stats_path.empty() || !config->trace_path.empty())
 	{
-		std::cout << "Generating mipmaps" << std::endl;
-		texture.generate_mipmap_chain();
+		atk::Tracer::start();
 	}
 
-	if (config.convert)
+	if (config->convert && config->target_format != "astc")
 	{
-		if (config.target_format == "astc")
+		std::cerr << "[ERROR] Format not supported: " << config->target_format << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if (!config->server_path.empty())
+	{
+		return atk::serve_jobs(*config);
+	}
+
+	auto &inputs = config->input_images;
+	if (inputs.empty())
+	{
+		std::cerr << "[ERROR] No input image" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// One slot per texture, so workers never share an error message
+	std::vector<std::string> errors(config->get_texture_count());
+
+	auto start = std::chrono::steady_clock::now();
+
+	auto up_to_date_count = atk::convert_images(*config, errors);
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	auto failed_count = std::count_if(std::begin(errors), std::end(errors), [](const std::string &e) { return !e.empty(); });
+
+	for (size_t i = 0; i < errors.size(); ++i)
+	{
+		if (!errors[i].empty())
 		{
-			std::cout << "Converting to astc" << std::endl;
-			texture.convert(atk::Format::ASTC);
+			std::cerr << "[ERROR] " << config->get_texture_input(i) << ": " << errors[i] << "\n";
 		}
-		else
+	}
+
+	if (errors.size() > 1)
+	{
+		auto converted_count = errors.size() - failed_count;
+		std::cout << "Converted " << converted_count << "/" << errors.size() << " files in "
+		          << elapsed.count() << "s (" << errors.size() / elapsed.count() << " files/s)\n";
+	}
+
+	if (config->manifest)
+	{
+		if (up_to_date_count > 0)
+		{
+			std::cout << up_to_date_count << " files were up to date\n";
+		}
+
+		try
+		{
+			config->manifest->save();
+		}
+		catch (const std::exception &e)
 		{
-			std::cerr << "[ERROR] Format not supported: " << config.target_format << std::endl;
+			std::cerr << "[ERROR] " << e.what() << std::endl;
+			return EXIT_FAILURE;
 		}
 	}
 
-	try
+	auto &stats = config->encode_stats;
+	if (stats.block_count > 0)
 	{
-		atk::Ktx ktx{texture};
+		std::cout << "Blocks: " << stats.block_count << " (" << stats.constant_block_count << " constant, "
+		          << stats.duplicate_block_count << " duplicate)\n";
+	}
 
-		auto ktx_name = atk::get_basename_no_extension(image_path) + ".ktx";
-		ktx.save_to_file(ktx_name);
+	if (config->cache)
+	{
+		std::cout << "Cache: " << config->cache->get_hit_count() << " hits, " << config->cache->get_miss_count() << " misses\n";
 	}
-	catch (const std::runtime_error &e)
+
+	if (inputs.size() > 1)
 	{
-		std::cerr << e.what() << std::endl;
-		return EXIT_FAILURE;
+		auto buffers = atk::BufferPool::get_default().get_stats();
+		std::cout << "Buffers: " << buffers.allocation_count << " (" << buffers.reuse_count << " reused), peak "
+		          << (buffers.peak_used_size >> 20) << " MiB\n";
 	}
 
-	return EXIT_SUCCESS;
+	if (auto tracer = atk::Tracer::get())
+	{
+		try
+		{
+			// Written apart from the other output, so that it can be parsed as JSON
+			if (!config->stats_path.empty())
+			{
+				std::ofstream file{config->stats_path};
+				tracer->write_stats(file);
+				if (!file)
+				{
+					throw std::runtime_error{"Cannot write stats [" + config->stats_path + "]"};
+				}
+				std::cout << "Stats [" << config->stats_path << "]\n";
+			}
+
+			if (!config->trace_path.empty())
+			{
+				tracer->write_chrome_trace(config->trace_path);
+				std::cout << "Trace [" << config->trace_path << "]\n";
+			}
+		}
+		catch (const std::exception &e)
+		{
+			std::cerr << "[ERROR] " << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	return failed_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
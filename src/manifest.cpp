@@ -0,0 +1,134 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/manifest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include "atk/storage.h"
+#include "atk/util.h"
+
+namespace atk
+{
+Manifest::Manifest(const std::string &p) :
+    path{p}
+{
+	std::ifstream file{path};
+
+	// One entry per line, fields separated by tabs
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream fields{line};
+
+		std::string output;
+		Entry       entry;
+		if (std::getline(fields, output, '\t') &&
+		    std::getline(fields, entry.input, '\t') &&
+		    std::getline(fields, entry.input_hash, '\t') &&
+		    std::getline(fields, entry.version, '\t') &&
+		    std::getline(fields, entry.options))
+		{
+			entries[output] = entry;
+		}
+	}
+}
+
+std::shared_ptr<Manifest> Manifest::get_shared(const std::string &manifest_path)
+{
+	// Weak, so a manifest no longer in use is loaded again with what was saved since
+	static std::mutex                                     shared_mutex;
+	static std::map<std::string, std::weak_ptr<Manifest>> shared;
+
+	std::lock_guard<std::mutex> lock{shared_mutex};
+
+	auto manifest = shared[manifest_path].lock();
+	if (!manifest)
+	{
+		manifest              = std::make_shared<Manifest>(manifest_path);
+		shared[manifest_path] = manifest;
+	}
+	return manifest;
+}
+
+std::string Manifest::hash_file(const std::string &file_path)
+{
+	MappedStorage storage{file_path};
+	return to_hex(get_hash(storage.get_data(), storage.get_size()));
+}
+
+bool Manifest::is_up_to_date(const std::string &output, const Entry &entry) const
+{
+	{
+		std::lock_guard<std::mutex> lock{entries_mutex};
+
+		auto it = entries.find(output);
+		if (it == entries.end())
+		{
+			return false;
+		}
+
+		auto &recorded = it->second;
+		if (recorded.input != entry.input || recorded.input_hash != entry.input_hash ||
+		    recorded.options != entry.options || recorded.version != entry.version)
+		{
+			return false;
+		}
+	}
+
+	// Output may have been deleted since
+	struct stat info;
+	return stat(output.c_str(), &info) == 0;
+}
+
+void Manifest::set(const std::string &output, const Entry &entry)
+{
+	std::lock_guard<std::mutex> lock{entries_mutex};
+	entries[output] = entry;
+}
+
+void Manifest::save() const
+{
+	auto temporary_path = get_temporary_path(path);
+
+	// Held until the rename, so an older snapshot never replaces a newer one
+	std::lock_guard<std::mutex> lock{entries_mutex};
+
+	std::ofstream file{temporary_path};
+	for (auto &it : entries)
+	{
+		auto &entry = it.second;
+		file << it.first << '\t' << entry.input << '\t' << entry.input_hash << '\t' << entry.version << '\t' << entry.options << '\n';
+	}
+	file.close();
+
+	if (!file || std::rename(temporary_path.c_str(), path.c_str()) != 0)
+	{
+		std::remove(temporary_path.c_str());
+		throw std::runtime_error{"Cannot write manifest [" + path + "]"};
+	}
+}
+
+}        // namespace atk
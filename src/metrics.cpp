@@ -0,0 +1,321 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+#include "atk/thread_pool.h"
+
+namespace atk
+{
+namespace
+{
+/// Side of the SSIM windows
+const uint32_t window_size = 8;
+
+/// Distance between two SSIM windows
+const uint32_t window_step = 4;
+
+/// Stabilizing constants of SSIM for 8 bit values
+const double ssim_c1 = (0.01 * 255) * (0.01 * 255);
+const double ssim_c2 = (0.03 * 255) * (0.03 * 255);
+
+/// @brief Sums of a band of rows
+struct Sums
+{
+	uint64_t squared_error[4] = {};
+
+	uint8_t max_error[4] = {};
+
+	double ssim[4] = {};
+
+	uint64_t window_count = 0;
+};
+
+/// @brief Accumulates the error of a run of texels, the channel count is a template
+///        argument so that the compiler can unroll and vectorize the loop
+template <uint32_t channels>
+void accumulate_run(const uint8_t *a, const uint8_t *b, const uint32_t texel_count, uint32_t *squared_error, uint8_t *max_error)
+{
+	for (uint32_t i = 0; i < texel_count; ++i)
+	{
+		for (uint32_t c = 0; c < channels; ++c)
+		{
+			int32_t delta = int32_t(a[i * channels + c]) - int32_t(b[i * channels + c]);
+			squared_error[c] += uint32_t(delta * delta);
+			max_error[c] = std::max(max_error[c], uint8_t(std::abs(delta)));
+		}
+	}
+}
+
+/// @brief Similarity of a window of each channel
+template <uint32_t channels>
+void accumulate_window(const uint8_t *a, const uint8_t *b, const size_t row_size, const uint32_t width, const uint32_t height, double *ssim)
+{
+	uint32_t sum_a[channels]  = {};
+	uint32_t sum_b[channels]  = {};
+	uint32_t sum_aa[channels] = {};
+	uint32_t sum_bb[channels] = {};
+	uint32_t sum_ab[channels] = {};
+
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		auto row_a = a + y * row_size;
+		auto row_b = b + y * row_size;
+		for (uint32_t i = 0; i < width; ++i)
+		{
+			for (uint32_t c = 0; c < channels; ++c)
+			{
+				uint32_t va = row_a[i * channels + c];
+				uint32_t vb = row_b[i * channels + c];
+				sum_a[c] += va;
+				sum_b[c] += vb;
+				sum_aa[c] += va * va;
+				sum_bb[c] += vb * vb;
+				sum_ab[c] += va * vb;
+			}
+		}
+	}
+
+	double count = double(width) * height;
+	for (uint32_t c = 0; c < channels; ++c)
+	{
+		double mean_a     = sum_a[c] / count;
+		double mean_b     = sum_b[c] / count;
+		double variance_a = sum_aa[c] / count - mean_a * mean_a;
+		double variance_b = sum_bb[c] / count - mean_b * mean_b;
+		double covariance = sum_ab[c] / count - mean_a * mean_b;
+
+		ssim[c] += ((2 * mean_a * mean_b + ssim_c1) * (2 * covariance + ssim_c2)) /
+		           ((mean_a * mean_a + mean_b * mean_b + ssim_c1) * (variance_a + variance_b + ssim_c2));
+	}
+}
+
+/// @return The first coordinate of each window along a dimension, a single
+///         window covers dimensions smaller than a window
+std::vector<uint32_t> get_window_starts(const uint32_t size)
+{
+	std::vector<uint32_t> starts{0};
+	for (uint32_t start = window_step; start + window_size <= size; start += window_step)
+	{
+		starts.emplace_back(start);
+	}
+	return starts;
+}
+
+/// @brief Measures a band of rows
+template <uint32_t channels>
+void measure_band(const uint8_t *a, const uint8_t *b, const uint32_t width, const uint32_t row_count, const uint32_t first_row,
+                  const uint32_t last_row, const MetricsOptions &options, const std::vector<uint32_t> &window_columns,
+                  const std::vector<uint32_t> &window_rows, Sums &sums, std::vector<uint64_t> &block_errors)
+{
+	auto row_size = size_t(width) * channels;
+
+	// Runs are short enough for their squared errors to fit 32 bits
+	auto run_size = options.block_width > 0 ? options.block_width : 4096;
+
+	for (auto y = first_row; y < last_row; ++y)
+	{
+		auto row_a = a + y * row_size;
+		auto row_b = b + y * row_size;
+
+		for (uint32_t x = 0, run = 0; x < width; x += run_size, ++run)
+		{
+			uint32_t squared_error[channels] = {};
+			accumulate_run<channels>(row_a + x * channels, row_b + x * channels, std::min(run_size, width - x), squared_error,
+			                         sums.max_error);
+
+			uint64_t run_error = 0;
+			for (uint32_t c = 0; c < channels; ++c)
+			{
+				sums.squared_error[c] += squared_error[c];
+				run_error += squared_error[c];
+			}
+
+			if (options.block_width > 0 && options.block_height > 0)
+			{
+				auto block_columns = (width + options.block_width - 1) / options.block_width;
+				block_errors[(y / options.block_height) * block_columns + run] += run_error;
+			}
+		}
+	}
+
+	if (!options.ssim)
+	{
+		return;
+	}
+
+	// Windows belong to the band holding their first row
+	auto window_width  = std::min(window_size, width);
+	auto window_height = std::min(window_size, row_count);
+	for (auto y : window_rows)
+	{
+		if (y < first_row || y >= last_row)
+		{
+			continue;
+		}
+
+		for (auto x : window_columns)
+		{
+			accumulate_window<channels>(a + y * row_size + x * channels, b + y * row_size + x * channels, row_size, window_width,
+			                            window_height, sums.ssim);
+			++sums.window_count;
+		}
+	}
+}
+
+}        // namespace
+
+double get_psnr(const double mse)
+{
+	return mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+}
+
+double Metrics::get_mse() const
+{
+	double sum = 0.0;
+	for (uint32_t c = 0; c < channel_count; ++c)
+	{
+		sum += mse[c];
+	}
+	return channel_count > 0 ? sum / channel_count : 0.0;
+}
+
+double Metrics::get_psnr() const
+{
+	return atk::get_psnr(get_mse());
+}
+
+double Metrics::get_ssim() const
+{
+	double sum = 0.0;
+	for (uint32_t c = 0; c < channel_count; ++c)
+	{
+		sum += ssim[c];
+	}
+	return channel_count > 0 ? sum / channel_count : 0.0;
+}
+
+uint8_t Metrics::get_max_error() const
+{
+	return *std::max_element(max_error, max_error + 4);
+}
+
+Metrics measure(const Image &reference, const Image &image, const MetricsOptions &options)
+{
+	if (reference.get_width() != image.get_width() || reference.get_height() != image.get_height() ||
+	    reference.get_depth() != image.get_depth() || reference.get_size() != image.get_size())
+	{
+		throw std::runtime_error{"Cannot measure images of different sizes"};
+	}
+
+	auto width       = reference.get_width();
+	auto texel_count = size_t(width) * reference.get_height() * reference.get_depth();
+	if (texel_count == 0 || (reference.get_size() != texel_count * 3 && reference.get_size() != texel_count * 4))
+	{
+		throw std::runtime_error{"Only RGB8 and RGBA8 images can be measured"};
+	}
+
+	Metrics metrics;
+	metrics.channel_count = static_cast<uint32_t>(reference.get_size() / texel_count);
+
+	// Slices of 3D images are measured as consecutive rows
+	auto row_count = reference.get_height() * reference.get_depth();
+
+	std::vector<uint64_t> block_errors;
+	if (options.block_width > 0 && options.block_height > 0)
+	{
+		metrics.block_columns = (width + options.block_width - 1) / options.block_width;
+		metrics.block_rows    = (row_count + options.block_height - 1) / options.block_height;
+		block_errors.resize(size_t(metrics.block_columns) * metrics.block_rows);
+	}
+
+	// Bands are made of whole block rows, so no block is shared by two bands
+	auto rows_per_block = std::max<uint32_t>(options.block_height, 1);
+	auto band_height    = rows_per_block * std::max<uint32_t>(32 / rows_per_block, 1);
+	auto band_count     = (row_count + band_height - 1) / band_height;
+
+	auto window_columns = get_window_starts(width);
+	auto window_rows    = get_window_starts(row_count);
+
+	std::vector<Sums> bands(band_count);
+
+	auto a = reference.get_data();
+	auto b = image.get_data();
+
+	ThreadPool::get_default().parallel_for(band_count, [&](size_t band) {
+		auto first_row = static_cast<uint32_t>(band * band_height);
+		auto last_row  = std::min(first_row + band_height, row_count);
+
+		if (metrics.channel_count == 4)
+		{
+			measure_band<4>(a, b, width, row_count, first_row, last_row, options, window_columns, window_rows, bands[band], block_errors);
+		}
+		else
+		{
+			measure_band<3>(a, b, width, row_count, first_row, last_row, options, window_columns, window_rows, bands[band], block_errors);
+		}
+	});
+
+	Sums total;
+	for (auto &band : bands)
+	{
+		for (uint32_t c = 0; c < metrics.channel_count; ++c)
+		{
+			total.squared_error[c] += band.squared_error[c];
+			total.max_error[c] = std::max(total.max_error[c], band.max_error[c]);
+			total.ssim[c] += band.ssim[c];
+		}
+		total.window_count += band.window_count;
+	}
+
+	for (uint32_t c = 0; c < metrics.channel_count; ++c)
+	{
+		metrics.mse[c]       = double(total.squared_error[c]) / texel_count;
+		metrics.psnr[c]      = atk::get_psnr(metrics.mse[c]);
+		metrics.max_error[c] = total.max_error[c];
+		metrics.ssim[c]      = total.window_count > 0 ? total.ssim[c] / total.window_count : 0.0;
+	}
+
+	if (!block_errors.empty())
+	{
+		metrics.block_mse.resize(block_errors.size());
+		for (uint32_t row = 0; row < metrics.block_rows; ++row)
+		{
+			auto block_height = std::min(options.block_height, row_count - row * options.block_height);
+			for (uint32_t column = 0; column < metrics.block_columns; ++column)
+			{
+				auto block_width = std::min(options.block_width, width - column * options.block_width);
+				auto index       = size_t(row) * metrics.block_columns + column;
+
+				metrics.block_mse[index] = double(block_errors[index]) / (size_t(block_width) * block_height * metrics.channel_count);
+			}
+		}
+	}
+
+	return metrics;
+}
+
+}        // namespace atk
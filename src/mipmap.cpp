@@ -0,0 +1,247 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/mipmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "atk/buffer_pool.h"
+#include "atk/thread_pool.h"
+
+namespace atk
+{
+/// Number of entries of the tables converting from linear values
+const size_t LINEAR_STEPS = 1 << 16;
+
+/// @brief Tables converting 8 bit channels to linear values and back
+struct MipmapFilter::TransferTables
+{
+	float to_linear[256];
+
+	uint8_t from_linear[LINEAR_STEPS];
+};
+
+namespace
+{
+MipmapFilter::TransferTables create_transfer_tables(const bool srgb)
+{
+	MipmapFilter::TransferTables tables;
+
+	for (size_t i = 0; i < 256; ++i)
+	{
+		float value = i / 255.0f;
+		if (srgb)
+		{
+			value = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+		tables.to_linear[i] = value;
+	}
+
+	for (size_t i = 0; i < LINEAR_STEPS; ++i)
+	{
+		float value = i / float(LINEAR_STEPS - 1);
+		if (srgb)
+		{
+			value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+		}
+		tables.from_linear[i] = static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+
+	return tables;
+}
+
+const MipmapFilter::TransferTables &get_transfer_tables(const bool srgb)
+{
+	static const MipmapFilter::TransferTables srgb_tables   = create_transfer_tables(true);
+	static const MipmapFilter::TransferTables linear_tables = create_transfer_tables(false);
+	return srgb ? srgb_tables : linear_tables;
+}
+
+}        // namespace
+
+MipmapFilter::Taps MipmapFilter::get_taps(const uint32_t dst, const uint32_t src_size)
+{
+	Taps taps;
+
+	if (src_size == 1)
+	{
+		taps.count      = 1;
+		taps.weights[0] = 1.0f;
+	}
+	else if (src_size % 2 == 0)
+	{
+		taps.first      = 2 * dst;
+		taps.count      = 2;
+		taps.weights[0] = 0.5f;
+		taps.weights[1] = 0.5f;
+	}
+	else
+	{
+		// Polyphase box filter: the 2m + 1 source texels are spread over
+		// m destination texels, so the footprint of each one is 2 + 1/m wide
+		auto half       = src_size / 2;
+		taps.first      = 2 * dst;
+		taps.count      = 3;
+		taps.weights[0] = float(half - dst) / src_size;
+		taps.weights[1] = float(half) / src_size;
+		taps.weights[2] = float(dst + 1) / src_size;
+	}
+
+	return taps;
+}
+
+MipmapFilter::MipmapFilter(const uint32_t width, const uint32_t height, const uint32_t gl_format) :
+    channels{get_channel_count(gl_format)},
+    src_width{width},
+    src_height{height},
+    dst_width{std::max<uint32_t>(width / 2, 1)},
+    dst_height{std::max<uint32_t>(height / 2, 1)}
+{
+	if (channels == 0)
+	{
+		throw std::runtime_error{"Cannot generate mipmaps of this image format"};
+	}
+
+	// Alpha is never sRGB encoded
+	for (uint32_t c = 0; c < channels; ++c)
+	{
+		tables[c] = &get_transfer_tables(is_srgb(gl_format) && c < 3);
+	}
+
+	column_taps.resize(dst_width);
+	for (uint32_t x = 0; x < dst_width; ++x)
+	{
+		column_taps[x] = get_taps(x, src_width);
+	}
+}
+
+uint32_t MipmapFilter::get_dst_width() const
+{
+	return dst_width;
+}
+
+uint32_t MipmapFilter::get_dst_height() const
+{
+	return dst_height;
+}
+
+uint32_t MipmapFilter::get_first_row(const uint32_t dst_row) const
+{
+	return get_taps(dst_row, src_height).first;
+}
+
+uint32_t MipmapFilter::get_row_count(const uint32_t dst_row) const
+{
+	return get_taps(dst_row, src_height).count;
+}
+
+void MipmapFilter::filter_row(const uint32_t dst_row, const uint8_t *src, uint8_t *dst, std::vector<float> &scratch) const
+{
+	auto src_row_size = size_t(src_width) * channels;
+
+	// Linear source row, and the vertically filtered one
+	scratch.resize(2 * src_row_size);
+	auto linear   = scratch.data();
+	auto filtered = scratch.data() + src_row_size;
+
+	auto row_taps = get_taps(dst_row, src_height);
+
+	std::fill(filtered, filtered + src_row_size, 0.0f);
+
+	for (uint32_t t = 0; t < row_taps.count; ++t)
+	{
+		auto src_row = src + t * src_row_size;
+		for (size_t i = 0; i < src_row_size; i += channels)
+		{
+			for (uint32_t c = 0; c < channels; ++c)
+			{
+				linear[i + c] = tables[c]->to_linear[src_row[i + c]];
+			}
+		}
+
+		auto weight = row_taps.weights[t];
+		for (size_t i = 0; i < src_row_size; ++i)
+		{
+			filtered[i] += weight * linear[i];
+		}
+	}
+
+	for (uint32_t x = 0; x < dst_width; ++x)
+	{
+		auto &taps = column_taps[x];
+		for (uint32_t c = 0; c < channels; ++c)
+		{
+			float value = 0.0f;
+			for (uint32_t t = 0; t < taps.count; ++t)
+			{
+				value += taps.weights[t] * filtered[(taps.first + t) * channels + c];
+			}
+
+			auto index            = static_cast<size_t>(std::min(std::max(value, 0.0f), 1.0f) * (LINEAR_STEPS - 1) + 0.5f);
+			dst[x * channels + c] = tables[c]->from_linear[index];
+		}
+	}
+}
+
+std::unique_ptr<Image> generate_mipmap(Image &image)
+{
+	auto gl_format = image.get_gl_format();
+
+	if (get_channel_count(gl_format) == 0 || image.get_depth() != 1)
+	{
+		throw std::runtime_error{"Cannot generate mipmaps of this image format"};
+	}
+
+	MipmapFilter filter{image.get_width(), image.get_height(), gl_format};
+
+	auto channels   = get_channel_count(gl_format);
+	auto dst_width  = filter.get_dst_width();
+	auto dst_height = filter.get_dst_height();
+
+	auto src     = image.get_data();
+	auto size    = size_t(dst_width) * dst_height * channels;
+	auto storage = BufferPool::get_default().allocate(size);
+	auto dst     = storage->get_buffer();
+
+	auto src_row_size = size_t(image.get_width()) * channels;
+	auto dst_row_size = size_t(dst_width) * channels;
+
+	// Bands of rows are filtered in parallel
+	const uint32_t rows_per_task = 16;
+	auto           task_count    = (dst_height + rows_per_task - 1) / rows_per_task;
+
+	ThreadPool::get_default().parallel_for(task_count, [&](size_t task) {
+		std::vector<float> scratch;
+
+		auto first_row = static_cast<uint32_t>(task * rows_per_task);
+		auto last_row  = std::min(first_row + rows_per_task, dst_height);
+
+		for (auto y = first_row; y < last_row; ++y)
+		{
+			filter.filter_row(y, src + filter.get_first_row(y) * src_row_size, dst + y * dst_row_size, scratch);
+		}
+	});
+
+	return std::unique_ptr<Image>{new Image{std::move(storage), 0, size, dst_width, dst_height, 1, gl_format}};
+}
+
+}        // namespace atk
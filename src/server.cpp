@@ -0,0 +1,469 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/server.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#	include <cerrno>
+#	include <csignal>
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#endif
+
+#include "atk/util.h"
+
+namespace atk
+{
+namespace
+{
+/// Latencies kept for the percentiles
+const size_t latency_count = 1024;
+
+/// @return The value below which a fraction of the sorted values lie
+double get_percentile(const std::vector<double> &sorted, const double fraction)
+{
+	if (sorted.empty())
+	{
+		return 0.0;
+	}
+	return sorted[static_cast<size_t>(fraction * (sorted.size() - 1))];
+}
+
+}        // namespace
+
+Server::Server(Handler h, const uint32_t worker_count) :
+    handler{std::move(h)},
+    start_time{std::chrono::steady_clock::now()}
+{
+	latencies.reserve(latency_count);
+
+	for (uint32_t i = 0; i < std::max<uint32_t>(worker_count, 1); ++i)
+	{
+		workers.emplace_back(&Server::work, this);
+	}
+}
+
+Server::~Server()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		stopping = true;
+	}
+	condition.notify_all();
+
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+}
+
+std::vector<std::string> Server::split_args(const std::string &line)
+{
+	std::vector<std::string> args;
+
+	std::string arg;
+	bool        in_arg   = false;
+	bool        in_quote = false;
+	for (auto c : line)
+	{
+		if (c == '"')
+		{
+			in_quote = !in_quote;
+			in_arg   = true;
+		}
+		else if (!in_quote && (c == ' ' || c == '\t' || c == '\r'))
+		{
+			if (in_arg)
+			{
+				args.emplace_back(std::move(arg));
+				arg.clear();
+				in_arg = false;
+			}
+		}
+		else
+		{
+			arg += c;
+			in_arg = true;
+		}
+	}
+
+	if (in_arg)
+	{
+		args.emplace_back(std::move(arg));
+	}
+
+	return args;
+}
+
+std::future<std::string> Server::submit(const std::vector<std::string> &args)
+{
+	Job job;
+	job.args        = args;
+	job.submit_time = std::chrono::steady_clock::now();
+
+	auto answer = job.answer.get_future();
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		job.id = next_id++;
+		jobs.emplace_back(std::move(job));
+	}
+	condition.notify_one();
+
+	return answer;
+}
+
+void Server::work()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock{mutex};
+			condition.wait(lock, [this] { return stopping || !jobs.empty(); });
+			if (jobs.empty())
+			{
+				return;        // stopping
+			}
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+			++running_count;
+		}
+
+		auto start = std::chrono::steady_clock::now();
+
+		ServerResponse response;
+		std::string    error;
+		try
+		{
+			response = handler(job.args);
+		}
+		catch (const std::exception &e)
+		{
+			response.ok = false;
+			error       = e.what();
+		}
+
+		// Files are read before answering, so a missing file fails the job
+		std::string         payload;
+		std::vector<size_t> sizes;
+		for (auto &file : response.files)
+		{
+			std::ifstream is{file, std::ios::binary};
+			if (!is)
+			{
+				response.ok = false;
+				error       = "Cannot read [" + file + "]";
+				payload.clear();
+				sizes.clear();
+				break;
+			}
+
+			std::string bytes{std::istreambuf_iterator<char>{is}, std::istreambuf_iterator<char>{}};
+			sizes.emplace_back(bytes.size());
+			payload += bytes;
+		}
+
+		auto end = std::chrono::steady_clock::now();
+
+		std::chrono::duration<double> queue_time = start - job.submit_time;
+		std::chrono::duration<double> job_time   = end - start;
+
+		std::ostringstream answer;
+		answer << "{\"id\": " << job.id << ", \"status\": " << (response.ok ? "\"ok\"" : "\"error\"");
+		if (!error.empty())
+		{
+			answer << ", \"error\": " << quote_json(error);
+		}
+		if (!response.fields.empty())
+		{
+			answer << ", " << response.fields;
+		}
+		answer << ", \"queue_s\": " << queue_time.count() << ", \"job_s\": " << job_time.count();
+		if (!sizes.empty())
+		{
+			answer << ", \"sizes\": [";
+			for (size_t i = 0; i < sizes.size(); ++i)
+			{
+				answer << (i ? ", " : "") << sizes[i];
+			}
+			answer << "]";
+		}
+		answer << "}\n" << payload;
+
+		{
+			std::lock_guard<std::mutex> lock{mutex};
+			--running_count;
+			++completed_count;
+			if (!response.ok)
+			{
+				++failed_count;
+			}
+
+			std::chrono::duration<double> latency = end - job.submit_time;
+			if (latencies.size() < latency_count)
+			{
+				latencies.emplace_back(latency.count());
+			}
+			else
+			{
+				latencies[next_latency] = latency.count();
+			}
+			next_latency = (next_latency + 1) % latency_count;
+		}
+
+		job.answer.set_value(answer.str());
+	}
+}
+
+Server::Stats Server::get_stats() const
+{
+	Stats stats;
+
+	std::vector<double> sorted;
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		stats.queue_depth     = jobs.size();
+		stats.running_count   = running_count;
+		stats.completed_count = completed_count;
+		stats.failed_count    = failed_count;
+		sorted                = latencies;
+	}
+
+	std::chrono::duration<double> uptime = std::chrono::steady_clock::now() - start_time;
+	stats.uptime_s                       = uptime.count();
+	stats.jobs_per_s                     = stats.uptime_s > 0.0 ? stats.completed_count / stats.uptime_s : 0.0;
+
+	std::sort(std::begin(sorted), std::end(sorted));
+	stats.latency_p50_s = get_percentile(sorted, 0.50);
+	stats.latency_p95_s = get_percentile(sorted, 0.95);
+	stats.latency_p99_s = get_percentile(sorted, 0.99);
+
+	return stats;
+}
+
+std::string Server::get_stats_json() const
+{
+	auto stats = get_stats();
+
+	std::ostringstream json;
+	json << "{\"queue_depth\": " << stats.queue_depth << ", \"running\": " << stats.running_count
+	     << ", \"completed\": " << stats.completed_count << ", \"failed\": " << stats.failed_count
+	     << ", \"uptime_s\": " << stats.uptime_s << ", \"jobs_per_s\": " << stats.jobs_per_s
+	     << ", \"latency_p50_s\": " << stats.latency_p50_s << ", \"latency_p95_s\": " << stats.latency_p95_s
+	     << ", \"latency_p99_s\": " << stats.latency_p99_s << "}";
+	return json.str();
+}
+
+std::string Server::handle_line(const std::string &line, bool &quit, bool &shutdown)
+{
+	auto args = split_args(line);
+	if (args.empty())
+	{
+		return {};
+	}
+
+	if (args.size() == 1)
+	{
+		if (args[0] == "stats")
+		{
+			return get_stats_json() + "\n";
+		}
+
+		if (args[0] == "quit")
+		{
+			quit = true;
+			return {};
+		}
+
+		if (args[0] == "shutdown")
+		{
+			quit     = true;
+			shutdown = true;
+			return "{\"status\": \"shutdown\"}\n";
+		}
+	}
+
+	return submit(args).get();
+}
+
+void Server::serve(std::istream &is, std::ostream &os)
+{
+	bool        quit     = false;
+	bool        shutdown = false;
+	std::string line;
+	while (!quit && std::getline(is, line))
+	{
+		os << handle_line(line, quit, shutdown) << std::flush;
+	}
+}
+
+#if defined(_WIN32)
+
+void Server::listen(const std::string &socket_path)
+{
+	throw std::runtime_error{"Unix domain sockets are not supported, serve stdin instead"};
+}
+
+void Server::serve_client(int client)
+{}
+
+void Server::stop_listening()
+{}
+
+#else
+
+void Server::listen(const std::string &socket_path)
+{
+	// A client leaving early should not kill the server
+	std::signal(SIGPIPE, SIG_IGN);
+
+	sockaddr_un address = {};
+	address.sun_family  = AF_UNIX;
+	if (socket_path.size() >= sizeof(address.sun_path))
+	{
+		throw std::runtime_error{"Socket path too long [" + socket_path + "]"};
+	}
+	std::copy(std::begin(socket_path), std::end(socket_path), address.sun_path);
+
+	auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0)
+	{
+		throw std::runtime_error{"Cannot create socket"};
+	}
+
+	::unlink(socket_path.c_str());
+	if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(fd, 16) != 0)
+	{
+		::close(fd);
+		throw std::runtime_error{"Cannot listen on [" + socket_path + "]"};
+	}
+
+	listener = fd;
+
+	std::vector<std::thread> client_threads;
+	while (listener >= 0)
+	{
+		auto client = ::accept(fd, nullptr, nullptr);
+		if (client < 0)
+		{
+			if (listener >= 0 && errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+
+		// A client accepted while stopping would miss the shutdown of the others
+		std::lock_guard<std::mutex> lock{mutex};
+		if (stopping || listener < 0)
+		{
+			::close(client);
+			break;
+		}
+		clients.insert(client);
+		client_threads.emplace_back(&Server::serve_client, this, client);
+	}
+
+	stop_listening();
+	for (auto &thread : client_threads)
+	{
+		thread.join();
+	}
+
+	::close(fd);
+	::unlink(socket_path.c_str());
+}
+
+void Server::serve_client(const int client)
+{
+	std::string buffer;
+	char        chunk[4096];
+
+	bool quit     = false;
+	bool shutdown = false;
+	while (!quit)
+	{
+		auto end = buffer.find('\n');
+		if (end == std::string::npos)
+		{
+			auto count = ::recv(client, chunk, sizeof(chunk), 0);
+			if (count <= 0)
+			{
+				break;        // disconnected
+			}
+			buffer.append(chunk, count);
+			continue;
+		}
+
+		auto answer = handle_line(buffer.substr(0, end), quit, shutdown);
+		buffer.erase(0, end + 1);
+
+		for (size_t sent = 0; sent < answer.size();)
+		{
+			auto count = ::send(client, answer.data() + sent, answer.size() - sent, 0);
+			if (count <= 0)
+			{
+				quit = true;
+				break;
+			}
+			sent += count;
+		}
+	}
+
+	// Answered before the other clients stop sending
+	if (shutdown)
+	{
+		stop_listening();
+	}
+
+	std::lock_guard<std::mutex> lock{mutex};
+	clients.erase(client);
+	::close(client);
+}
+
+void Server::stop_listening()
+{
+	// Shutting the listener down wakes the accepting thread, which closes it afterwards
+	auto fd = listener.exchange(-1);
+	if (fd >= 0)
+	{
+		::shutdown(fd, SHUT_RDWR);
+	}
+
+	// Clients can no longer send, but the requests already sent are still read and
+	// answered, jobs in progress included. Their threads then see the end of the stream
+	std::lock_guard<std::mutex> lock{mutex};
+	for (auto client : clients)
+	{
+		::shutdown(client, SHUT_RD);
+	}
+}
+
+#endif
+
+}        // namespace atk
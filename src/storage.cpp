@@ -0,0 +1,146 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/storage.h"
+
+#include <fstream>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+namespace atk
+{
+HeapStorage::HeapStorage(uint8_t *d, const size_t s) :
+    data{d},
+    size{s}
+{
+}
+
+HeapStorage::~HeapStorage()
+{
+	delete[] data;
+}
+
+const uint8_t *HeapStorage::get_data() const
+{
+	return data;
+}
+
+size_t HeapStorage::get_size() const
+{
+	return size;
+}
+
+ViewStorage::ViewStorage(const uint8_t *d, const size_t s) :
+    data{d},
+    size{s}
+{
+}
+
+const uint8_t *ViewStorage::get_data() const
+{
+	return data;
+}
+
+size_t ViewStorage::get_size() const
+{
+	return size;
+}
+
+MappedStorage::MappedStorage(const std::string &path)
+{
+#if defined(_WIN32)
+	// No mapping, read the whole file instead
+	std::ifstream file{path, std::ios::binary | std::ios::ate};
+	if (!file)
+	{
+		throw std::runtime_error{"Could not open [" + path + "]"};
+	}
+
+	size = static_cast<size_t>(file.tellg());
+	data = new uint8_t[size];
+
+	file.seekg(0);
+	if (!file.read(reinterpret_cast<char *>(data), size))
+	{
+		delete[] data;
+		throw std::runtime_error{"Could not read [" + path + "]"};
+	}
+#else
+	auto file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		throw std::runtime_error{"Could not open [" + path + "]"};
+	}
+
+	struct stat info;
+	if (fstat(file, &info) != 0)
+	{
+		close(file);
+		throw std::runtime_error{"Could not read [" + path + "]"};
+	}
+
+	size = static_cast<size_t>(info.st_size);
+	if (size == 0)
+	{
+		close(file);
+		return;        // nothing to map
+	}
+
+	auto mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if (mapping == MAP_FAILED)
+	{
+		throw std::runtime_error{"Could not map [" + path + "]"};
+	}
+
+	data = reinterpret_cast<uint8_t *>(mapping);
+#endif
+}
+
+MappedStorage::~MappedStorage()
+{
+#if defined(_WIN32)
+	delete[] data;
+#else
+	if (data)
+	{
+		munmap(data, size);
+	}
+#endif
+}
+
+const uint8_t *MappedStorage::get_data() const
+{
+	return data;
+}
+
+size_t MappedStorage::get_size() const
+{
+	return size;
+}
+
+}        // namespace atk
@@ -0,0 +1,257 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/strip_encoder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+#include "atk/thread_pool.h"
+#include "atk/trace.h"
+
+namespace atk
+{
+StripEncoder::StripEncoder(KtxWriter &w, const uint32_t width, const uint32_t height, const uint32_t f, const EncodeOptions &o, const uint32_t strip_block_rows) :
+    writer{w},
+    gl_format{f},
+    options{o},
+    strip_row_count{std::max<uint32_t>(strip_block_rows, 1) * o.block_dim.y}
+{
+	if (get_channel_count(gl_format) != 4)
+	{
+		throw std::runtime_error{"Strips can only be encoded from RGBA8 rows"};
+	}
+
+	levels.resize(writer.get_level_count());
+	for (uint32_t l = 0; l < levels.size(); ++l)
+	{
+		auto &level  = levels[l];
+		level.width  = std::max<uint32_t>(width >> l, 1);
+		level.height = std::max<uint32_t>(height >> l, 1);
+
+		if (l + 1 < levels.size())
+		{
+			level.filter.reset(new MipmapFilter{level.width, level.height, gl_format});
+		}
+	}
+}
+
+void StripEncoder::push_rows(const uint8_t *rows, const uint32_t row_count)
+{
+	assert(!levels.empty() && levels[0].row_count + row_count <= levels[0].height && "Rows exceed the image");
+
+	append(levels[0], rows, row_count);
+
+	// Rows of a level have to be filtered before its strips are encoded, as they are
+	// read from the level while encoding, and both before the rows can be dropped
+	filter_levels();
+	encode_strips();
+	drop_rows();
+}
+
+bool StripEncoder::is_complete() const
+{
+	return std::all_of(std::begin(levels), std::end(levels), [](const Level &level) { return level.encoded_row_count == level.height; });
+}
+
+uint32_t StripEncoder::get_peak_row_count() const
+{
+	return peak_row_count;
+}
+
+void StripEncoder::append(Level &level, const uint8_t *rows, const uint32_t row_count)
+{
+	auto row_size = size_t(level.width) * 4;
+	level.rows.insert(std::end(level.rows), rows, rows + row_count * row_size);
+	level.row_count += row_count;
+
+	peak_row_count = std::max(peak_row_count, static_cast<uint32_t>(level.rows.size() / row_size));
+}
+
+void StripEncoder::filter_levels()
+{
+	// Rows added to a level are filtered by the same loop into the following one
+	for (size_t l = 0; l + 1 < levels.size(); ++l)
+	{
+		auto &level  = levels[l];
+		auto &filter = *level.filter;
+
+		auto first = level.filtered_row_count;
+		auto last  = first;
+		while (last < filter.get_dst_height() && filter.get_first_row(last) + filter.get_row_count(last) <= level.row_count)
+		{
+			++last;
+		}
+
+		if (last == first)
+		{
+			continue;
+		}
+
+		auto &next         = levels[l + 1];
+		auto  src_row_size = size_t(level.width) * 4;
+		auto  dst_row_size = size_t(next.width) * 4;
+
+		TraceScope trace{"mipmap", int32_t(l + 1), (last - first) * dst_row_size};
+
+		std::vector<uint8_t> rows((last - first) * dst_row_size);
+
+		// Bands of rows are filtered in parallel
+		const uint32_t rows_per_task = 16;
+		auto           task_count    = (last - first + rows_per_task - 1) / rows_per_task;
+
+		ThreadPool::get_default().parallel_for(task_count, [&](size_t task) {
+			std::vector<float> scratch;
+
+			auto first_row = first + static_cast<uint32_t>(task * rows_per_task);
+			auto last_row  = std::min(first_row + rows_per_task, last);
+
+			for (auto y = first_row; y < last_row; ++y)
+			{
+				auto src = level.rows.data() + (filter.get_first_row(y) - level.first_row) * src_row_size;
+				filter.filter_row(y, src, rows.data() + (y - first) * dst_row_size, scratch);
+			}
+		});
+
+		level.filtered_row_count = last;
+		append(next, rows.data(), last - first);
+	}
+}
+
+void StripEncoder::encode_strips()
+{
+	auto &block_dim = options.block_dim;
+
+	std::vector<Image>     strips;
+	std::vector<uint8_t *> outputs;
+	strips.reserve(levels.size());
+
+	for (uint32_t l = 0; l < levels.size(); ++l)
+	{
+		auto &level = levels[l];
+
+		// Whole strips, or whatever is left at the end of the level
+		auto pending = level.row_count - level.encoded_row_count;
+		auto ready   = level.row_count == level.height ? pending : pending / strip_row_count * strip_row_count;
+		if (ready == 0)
+		{
+			continue;
+		}
+
+		auto row_size = size_t(level.width) * 4;
+		auto offset   = (level.encoded_row_count - level.first_row) * row_size;
+		auto size     = ready * row_size;
+		strips.emplace_back(std::make_shared<ViewStorage>(level.rows.data() + offset, size), 0, size, level.width, ready, 1, gl_format);
+
+		// Strips begin on a block row, whose blocks follow those of the previous rows
+		auto xblocks    = (level.width + block_dim.x - 1) / block_dim.x;
+		auto block_rows = level.encoded_row_count / block_dim.y;
+		outputs.emplace_back(writer.get_image_data(l) + size_t(block_rows) * xblocks * 16);
+
+		level.encoded_row_count += ready;
+	}
+
+	if (strips.empty())
+	{
+		return;
+	}
+
+	std::vector<Image *> images;
+	for (auto &strip : strips)
+	{
+		images.emplace_back(&strip);
+	}
+
+	Astc::encode_to(images, outputs, options);
+}
+
+void StripEncoder::drop_rows()
+{
+	for (auto &level : levels)
+	{
+		auto keep = level.encoded_row_count;
+		if (level.filter && level.filtered_row_count < level.filter->get_dst_height())
+		{
+			keep = std::min(keep, level.filter->get_first_row(level.filtered_row_count));
+		}
+
+		if (keep > level.first_row)
+		{
+			auto row_size = size_t(level.width) * 4;
+			level.rows.erase(std::begin(level.rows), std::begin(level.rows) + (keep - level.first_row) * row_size);
+			level.first_row = keep;
+		}
+	}
+}
+
+uint32_t get_mipmap_level_count(uint32_t width, uint32_t height)
+{
+	uint32_t level_count = 1;
+
+	// Last mipmap should be 1x1
+	while (width > 1 || height > 1)
+	{
+		width  = std::max<uint32_t>(width / 2, 1);
+		height = std::max<uint32_t>(height / 2, 1);
+		++level_count;
+	}
+
+	return level_count;
+}
+
+void write_astc_ktx_strips(MagickImage &image, const std::string &path, const bool mipmaps, const EncodeOptions &options, const uint32_t strip_block_rows)
+{
+	auto gl_format = get_astc_gl_format(options.block_dim, options.srgb);
+	if (gl_format == 0)
+	{
+		throw std::runtime_error{"Invalid astc block footprint"};
+	}
+
+	image.convert(Format::RGBA);
+
+	auto width       = image.get_width();
+	auto height      = image.get_height();
+	auto level_count = mipmaps ? get_mipmap_level_count(width, height) : 1;
+
+	KtxWriter writer{gl_format, width, height, level_count};
+	writer.open(path);
+
+	StripEncoder encoder{writer, width, height, image.get_gl_format(), options, strip_block_rows};
+
+	auto                 strip_row_count = std::max<uint32_t>(strip_block_rows, 1) * options.block_dim.y;
+	std::vector<uint8_t> strip(size_t(strip_row_count) * width * 4);
+
+	for (uint32_t row = 0; row < height; row += strip_row_count)
+	{
+		auto row_count = std::min(strip_row_count, height - row);
+		{
+			TraceScope trace{"export", -1, size_t(row_count) * width * 4};
+			image.export_rows(row, row_count, strip.data());
+		}
+		encoder.push_rows(strip.data(), row_count);
+	}
+
+	assert(encoder.is_complete() && "Every level should be encoded");
+
+	writer.close();
+}
+
+}        // namespace atk
@@ -1,47 +1,111 @@
 #include "atk/texture.h"
 
 #include <algorithm>
+#include <cassert>
+#include <stdexcept>
 
 #include "atk/astc.h"
+#include "atk/mipmap.h"
+#include "atk/trace.h"
 
 namespace atk
 {
 Texture::Texture(std::unique_ptr<Image> &&i) :
-    image{std::move(i)}
+    mipmap_chains(1)
 {
+	images.emplace_back(std::move(i));
+}
+
+Texture::Texture(std::vector<std::unique_ptr<Image>> &&i, const uint32_t layers, const uint32_t faces) :
+    images{std::move(i)},
+    mipmap_chains(images.size()),
+    layer_count{layers},
+    face_count{faces}
+{
+	if (layer_count == 0 || (face_count != 1 && face_count != 6) || images.size() != layer_count * face_count)
+	{
+		throw std::runtime_error{"Cannot create texture: wrong number of layers or faces"};
+	}
+
+	auto &base = *images.front();
+	for (auto &image : images)
+	{
+		assert(image && "Texture image is null");
+		if (image->get_width() != base.get_width() || image->get_height() != base.get_height() ||
+		    image->get_depth() != base.get_depth())
+		{
+			throw std::runtime_error{"Cannot create texture: layers and faces differ in size"};
+		}
+	}
+
+	if (face_count == 6 && base.get_width() != base.get_height())
+	{
+		throw std::runtime_error{"Cannot create texture: cubemap faces are not square"};
+	}
 }
 
 Image &Texture::get_image()
 {
-	assert(image && "Texture has no image");
-	return *image;
+	assert(images.front() && "Texture has no image");
+	return *images.front();
 }
 
-void Texture::generate_mipmap_chain()
+Image &Texture::get_level(const uint32_t level, const uint32_t layer, const uint32_t face)
 {
-	assert(image && "Texture has no image");
+	if (level == 0)
+	{
+		return *images.at(layer * face_count + face);
+	}
+	return *get_mipmap_chain(layer, face).at(level - 1);
+}
+
+void Texture::generate_mipmap_chain(const MipmapGenerator generator)
+{
+	assert(images.front() && "Texture has no image");
 
-	if (!mipmap_chain.empty())
+	if (!mipmap_chains.front().empty())
 	{
 		return;        // already generated
 	}
 
-	auto next_width  = image->get_width();
-	auto next_height = image->get_height();
-
-	// Last mipmap should be 1x1
-	while (next_width != 1 || next_height != 1)
+	// Levels of a single image are filtered in parallel, so images are taken in turn
+	for (size_t i = 0; i < images.size(); ++i)
 	{
-		next_width  = std::max<size_t>(next_width / 2, 1);
-		next_height = std::max<size_t>(next_height / 2, 1);
+		auto &image        = images[i];
+		auto &mipmap_chain = mipmap_chains[i];
+
+		auto next_width  = image->get_width();
+		auto next_height = image->get_height();
 
-		auto mipmap = image->resize(next_width, next_height);
+		Image *previous = image.get();
 
-		mipmap_chain.emplace_back(std::move(mipmap));
+		// Last mipmap should be 1x1
+		while (next_width != 1 || next_height != 1)
+		{
+			next_width  = std::max<size_t>(next_width / 2, 1);
+			next_height = std::max<size_t>(next_height / 2, 1);
+
+			TraceScope trace{"mipmap", int32_t(mipmap_chain.size() + 1)};
+
+			std::unique_ptr<Image> mipmap;
+			if (generator == MipmapGenerator::Native)
+			{
+				mipmap = generate_mipmap(*previous);
+			}
+			else
+			{
+				mipmap = image->resize(next_width, next_height);
+			}
+
+			trace.set_bytes(mipmap->get_size());
+
+			previous = mipmap.get();
+			mipmap_chain.emplace_back(std::move(mipmap));
+		}
 	}
 }
 
-void Texture::convert(const Format format)
+void Texture::convert(const Format format, const EncodeOptions &options)
 {
 	switch (format)
 	{
@@ -53,16 +117,32 @@ void Texture::convert(const Format format)
 		}
 		case Format::ASTC:
 		{
-			auto to_astc = [](std::unique_ptr<Image> &img) {
-				// Make sure it is RGBA8
-				img->convert(Format::RGBA);
-				// Substitute image with a converted one
-				img.reset(new Astc{Astc::encode_from(*img)});
-			};
+			std::vector<std::unique_ptr<Image> *> levels;
+			for (size_t i = 0; i < images.size(); ++i)
+			{
+				levels.emplace_back(&images[i]);
+				for (auto &mipmap : mipmap_chains[i])
+				{
+					levels.emplace_back(&mipmap);
+				}
+			}
+
+			// Make sure they are RGBA8
+			std::vector<Image *> sources;
+			for (auto level : levels)
+			{
+				(*level)->convert(Format::RGBA);
+				sources.emplace_back(level->get());
+			}
 
-			to_astc(image);
+			// Encode every level of every layer and face at the same time
+			auto astcs = Astc::encode_from(sources, options);
 
-			std::for_each(std::begin(mipmap_chain), std::end(mipmap_chain), to_astc);
+			// Substitute images with converted ones
+			for (size_t i = 0; i < levels.size(); ++i)
+			{
+				levels[i]->reset(new Astc{std::move(astcs[i])});
+			}
 		}
 	}
 }
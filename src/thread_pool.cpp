@@ -0,0 +1,220 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+
+#if defined(__linux__)
+#	include <sched.h>
+#endif
+
+namespace atk
+{
+namespace
+{
+std::mutex default_pool_mutex;
+
+std::unique_ptr<ThreadPool> default_pool;
+
+uint32_t default_thread_count = 0;
+
+}        // namespace
+
+uint32_t get_available_thread_count()
+{
+#if defined(__linux__)
+	cpu_set_t cpu_set;
+	CPU_ZERO(&cpu_set);
+	if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
+	{
+		auto count = CPU_COUNT(&cpu_set);
+		if (count > 0)
+		{
+			return static_cast<uint32_t>(count);
+		}
+	}
+#endif
+
+	return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+ThreadPool::ThreadPool(uint32_t thread_count)
+{
+	if (thread_count == 0)
+	{
+		thread_count = get_available_thread_count();
+	}
+
+	// The calling thread works as well
+	for (uint32_t i = 1; i < thread_count; ++i)
+	{
+		workers.emplace_back(&ThreadPool::work, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		stopping = true;
+	}
+	condition.notify_all();
+
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+}
+
+uint32_t ThreadPool::get_thread_count() const
+{
+	return static_cast<uint32_t>(workers.size() + 1);
+}
+
+void ThreadPool::work()
+{
+	while (true)
+	{
+		std::function<void()> task;
+
+		{
+			std::unique_lock<std::mutex> lock{mutex};
+			condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+
+			if (tasks.empty())
+			{
+				return;        // stopping
+			}
+
+			task = std::move(tasks.front());
+			tasks.pop_front();
+		}
+
+		task();
+	}
+}
+
+void ThreadPool::parallel_for(const size_t count, const std::function<void(size_t)> &func)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	/// State shared by every thread working on this loop
+	struct Loop
+	{
+		std::atomic<size_t> next{0};
+		std::atomic<size_t> done{0};
+		std::atomic<bool>   failed{false};
+		size_t              count = 0;
+
+		const std::function<void(size_t)> *func = nullptr;
+
+		std::exception_ptr      error;
+		std::mutex              mutex;
+		std::condition_variable condition;
+	};
+
+	auto loop   = std::make_shared<Loop>();
+	loop->count = count;
+	loop->func  = &func;
+
+	// Helpers may start after the loop is over, therefore they only touch
+	// the function while there are indices left and the caller is waiting
+	auto run = [loop] {
+		size_t index;
+		while ((index = loop->next++) < loop->count)
+		{
+			if (!loop->failed)
+			{
+				try
+				{
+					(*loop->func)(index);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock{loop->mutex};
+					if (!loop->error)
+					{
+						loop->error = std::current_exception();
+					}
+					loop->failed = true;
+				}
+			}
+
+			if (++loop->done == loop->count)
+			{
+				std::lock_guard<std::mutex> lock{loop->mutex};
+				loop->condition.notify_all();
+			}
+		}
+	};
+
+	auto helper_count = std::min(workers.size(), count - 1);
+	if (helper_count > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock{mutex};
+			for (size_t i = 0; i < helper_count; ++i)
+			{
+				tasks.emplace_back(run);
+			}
+		}
+		condition.notify_all();
+	}
+
+	run();
+
+	std::unique_lock<std::mutex> lock{loop->mutex};
+	loop->condition.wait(lock, [&loop] { return loop->done == loop->count; });
+
+	if (loop->error)
+	{
+		std::rethrow_exception(loop->error);
+	}
+}
+
+ThreadPool &ThreadPool::get_default()
+{
+	std::lock_guard<std::mutex> lock{default_pool_mutex};
+	if (!default_pool)
+	{
+		default_pool.reset(new ThreadPool{default_thread_count});
+	}
+	return *default_pool;
+}
+
+void ThreadPool::set_default_thread_count(const uint32_t thread_count)
+{
+	std::lock_guard<std::mutex> lock{default_pool_mutex};
+	if (default_pool)
+	{
+		throw std::logic_error{"The thread count is set before the default thread pool is used"};
+	}
+	default_thread_count = thread_count;
+}
+
+}        // namespace atk
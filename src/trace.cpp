@@ -0,0 +1,283 @@
+/* Copyright (c) 2019, ARM Limited and Contributors
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "atk/trace.h"
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#	include <windows.h>
+#else
+#	include <time.h>
+#endif
+
+#include "atk/util.h"
+
+namespace atk
+{
+namespace
+{
+/// File tied to the stages of the calling thread
+thread_local std::string current_file;
+
+/// @return A small number identifying the calling thread
+uint32_t get_thread_id()
+{
+	static std::atomic<uint32_t> next_id{1};
+	thread_local uint32_t        id = next_id++;
+	return id;
+}
+
+/// @return The time the calling thread ran on a CPU
+uint64_t get_thread_cpu_ns()
+{
+#if defined(_WIN32)
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+	{
+		return 0;
+	}
+	auto to_ns = [](const FILETIME &time) { return ((uint64_t(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100; };
+	return to_ns(kernel) + to_ns(user);
+#else
+	timespec time;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0)
+	{
+		return 0;
+	}
+	return uint64_t(time.tv_sec) * 1000000000 + uint64_t(time.tv_nsec);
+#endif
+}
+
+/// @brief Totals of the events of a stage
+struct StageTotals
+{
+	uint64_t count = 0;
+
+	uint64_t wall_ns = 0;
+
+	uint64_t cpu_ns = 0;
+
+	uint64_t bytes = 0;
+};
+
+void write_totals(std::ostream &os, const StageTotals &totals)
+{
+	os << "\"count\": " << totals.count << ", \"wall_s\": " << totals.wall_ns / 1e9 << ", \"cpu_s\": " << totals.cpu_ns / 1e9
+	   << ", \"bytes\": " << totals.bytes;
+}
+
+}        // namespace
+
+std::atomic<Tracer *> Tracer::instance{nullptr};
+
+Tracer::Tracer() :
+    start_time{std::chrono::steady_clock::now()}
+{
+}
+
+void Tracer::start()
+{
+	// Leaked on purpose, so threads can record events until the very end
+	static auto tracer = new Tracer{};
+	instance.store(tracer, std::memory_order_release);
+}
+
+uint64_t Tracer::get_time_ns() const
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void Tracer::record(TraceEvent &&event)
+{
+	std::lock_guard<std::mutex> lock{mutex};
+	events.emplace_back(std::move(event));
+}
+
+std::vector<TraceEvent> Tracer::get_events() const
+{
+	std::lock_guard<std::mutex> lock{mutex};
+	return events;
+}
+
+void Tracer::write_chrome_trace(const std::string &path) const
+{
+	auto trace_events = get_events();
+
+	std::ofstream file{path};
+	if (!file)
+	{
+		throw std::runtime_error{"Cannot write trace [" + path + "]"};
+	}
+
+	// Complete events, times are in microseconds
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	for (size_t i = 0; i < trace_events.size(); ++i)
+	{
+		auto &event = trace_events[i];
+
+		file << "{\"name\": " << quote_json(event.name) << ", \"cat\": \"ktx-creator\", \"ph\": \"X\", \"pid\": 1"
+		     << ", \"tid\": " << event.thread_id << ", \"ts\": " << event.start_ns / 1e3 << ", \"dur\": " << event.wall_ns / 1e3
+		     << ", \"args\": {\"cpu_us\": " << event.cpu_ns / 1e3 << ", \"bytes\": " << event.bytes
+		     << ", \"peak_rss\": " << event.peak_rss;
+		if (!event.file.empty())
+		{
+			file << ", \"file\": " << quote_json(event.file);
+		}
+		if (event.level >= 0)
+		{
+			file << ", \"level\": " << event.level;
+		}
+		file << "}}" << (i + 1 < trace_events.size() ? ",\n" : "\n");
+	}
+	file << "]}\n";
+
+	if (!file)
+	{
+		throw std::runtime_error{"Cannot write trace [" + path + "]"};
+	}
+}
+
+void Tracer::write_stats(std::ostream &os) const
+{
+	auto trace_events = get_events();
+
+	std::map<std::string, StageTotals> stages;
+
+	// Files in the order they started, with their events
+	std::vector<std::pair<std::string, std::vector<const TraceEvent *>>> files;
+	std::map<std::string, size_t>                                         file_indices;
+
+	for (auto &event : trace_events)
+	{
+		auto &totals = stages[event.name];
+		++totals.count;
+		totals.wall_ns += event.wall_ns;
+		totals.cpu_ns += event.cpu_ns;
+		totals.bytes += event.bytes;
+
+		if (!event.file.empty())
+		{
+			auto found = file_indices.emplace(event.file, files.size());
+			if (found.second)
+			{
+				files.emplace_back(event.file, std::vector<const TraceEvent *>{});
+			}
+			files[found.first->second].second.emplace_back(&event);
+		}
+	}
+
+	auto flags     = os.flags();
+	auto precision = os.precision(6);
+	os << std::fixed;
+
+	os << "{\n  \"wall_s\": " << get_time_ns() / 1e9 << ",\n  \"peak_rss\": " << get_peak_rss() << ",\n  \"stages\": {";
+	size_t index = 0;
+	for (auto &stage : stages)
+	{
+		os << (index++ ? "," : "") << "\n    " << quote_json(stage.first) << ": {";
+		write_totals(os, stage.second);
+		os << "}";
+	}
+	os << "\n  },\n  \"files\": [";
+
+	for (size_t f = 0; f < files.size(); ++f)
+	{
+		os << (f ? "," : "") << "\n    {\"file\": " << quote_json(files[f].first) << ", \"stages\": [";
+
+		auto &file_events = files[f].second;
+		for (size_t e = 0; e < file_events.size(); ++e)
+		{
+			auto &event = *file_events[e];
+			os << (e ? "," : "") << "\n      {\"stage\": " << quote_json(event.name);
+			if (event.level >= 0)
+			{
+				os << ", \"level\": " << event.level;
+			}
+			os << ", \"wall_s\": " << event.wall_ns / 1e9 << ", \"cpu_s\": " << event.cpu_ns / 1e9 << ", \"bytes\": " << event.bytes
+			   << ", \"peak_rss\": " << event.peak_rss << "}";
+		}
+		os << "\n    ]}";
+	}
+	os << "\n  ]\n}\n";
+
+	os.flags(flags);
+	os.precision(precision);
+}
+
+TraceScope::TraceScope(const char *name, const int32_t level, const uint64_t bytes) :
+    tracer{Tracer::get()}
+{
+	if (!tracer)
+	{
+		return;
+	}
+
+	event.name     = name;
+	event.file     = current_file;
+	event.level    = level;
+	event.bytes    = bytes;
+	event.start_ns = tracer->get_time_ns();
+	start_cpu_ns   = get_thread_cpu_ns();
+}
+
+TraceScope::~TraceScope()
+{
+	if (!tracer)
+	{
+		return;
+	}
+
+	event.wall_ns   = tracer->get_time_ns() - event.start_ns;
+	event.cpu_ns    = get_thread_cpu_ns() - start_cpu_ns;
+	event.thread_id = get_thread_id();
+	event.peak_rss  = get_peak_rss();
+	tracer->record(std::move(event));
+}
+
+void TraceScope::set_bytes(const uint64_t bytes)
+{
+	event.bytes = bytes;
+}
+
+TraceFile::TraceFile(const std::string &path) :
+    enabled{Tracer::get() != nullptr}
+{
+	if (enabled)
+	{
+		previous     = std::move(current_file);
+		current_file = path;
+	}
+}
+
+TraceFile::~TraceFile()
+{
+	if (enabled)
+	{
+		current_file = std::move(previous);
+	}
+}
+
+}        // namespace atk
@@ -1,5 +1,21 @@
 #include "atk/util.h"
 
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#	include <windows.h>
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#	include <unistd.h>
+#endif
+
+#ifndef KTX_CREATOR_VERSION
+#	define KTX_CREATOR_VERSION "unknown"
+#endif
+
 namespace atk
 {
 std::string get_basename_no_extension(const std::string &file_path)
@@ -44,4 +60,138 @@ std::string get_extension(const std::string &file_path)
 	return ext;
 }
 
+std::string get_temporary_path(const std::string &path)
+{
+	static std::atomic<uint32_t> counter{0};
+
+#if defined(_WIN32)
+	auto process = std::string{};
+#else
+	auto process = std::to_string(getpid());
+#endif
+
+	return path + "." + process + "." + std::to_string(counter++) + ".tmp";
+}
+
+uint64_t get_hash(const void *data, const size_t size, const uint64_t seed)
+{
+	const uint64_t m = 0xc6a4a7935bd1e995ull;
+	const int      r = 47;
+
+	uint64_t h = seed ^ (size * m);
+
+	auto bytes = reinterpret_cast<const uint8_t *>(data);
+	auto end   = bytes + (size & ~size_t(7));
+
+	for (; bytes != end; bytes += 8)
+	{
+		uint64_t k;
+		std::memcpy(&k, bytes, sizeof(k));
+
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+
+		h ^= k;
+		h *= m;
+	}
+
+	// Remaining bytes
+	switch (size & 7)
+	{
+		case 7:
+			h ^= uint64_t(bytes[6]) << 48;
+			// fall through
+		case 6:
+			h ^= uint64_t(bytes[5]) << 40;
+			// fall through
+		case 5:
+			h ^= uint64_t(bytes[4]) << 32;
+			// fall through
+		case 4:
+			h ^= uint64_t(bytes[3]) << 24;
+			// fall through
+		case 3:
+			h ^= uint64_t(bytes[2]) << 16;
+			// fall through
+		case 2:
+			h ^= uint64_t(bytes[1]) << 8;
+			// fall through
+		case 1:
+			h ^= uint64_t(bytes[0]);
+			h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+
+	return h;
+}
+
+std::string to_hex(const uint64_t value)
+{
+	const char digits[] = "0123456789abcdef";
+
+	std::string hex(16, '0');
+	for (size_t i = 0; i < 16; ++i)
+	{
+		hex[15 - i] = digits[(value >> (i * 4)) & 0xF];
+	}
+	return hex;
+}
+
+const char *get_version()
+{
+	return KTX_CREATOR_VERSION;
+}
+
+std::string quote_json(const std::string &str)
+{
+	std::string quoted = "\"";
+	for (auto c : str)
+	{
+		if (c == '"' || c == '\\')
+		{
+			quoted += '\\';
+			quoted += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+		{
+			char escaped[8];
+			std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+			quoted += escaped;
+		}
+		else
+		{
+			quoted += c;
+		}
+	}
+	quoted += '"';
+	return quoted;
+}
+
+uint64_t get_peak_rss()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return counters.PeakWorkingSetSize;
+	}
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+#	if defined(__APPLE__)
+	return uint64_t(usage.ru_maxrss);        // bytes
+#	else
+	return uint64_t(usage.ru_maxrss) << 10;        // KiB
+#	endif
+#endif
+}
+
 }        // namespace atk
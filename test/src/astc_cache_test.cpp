@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <atk/astc.h>
+#include <atk/astc_cache.h>
+#include <atk/magick.h>
+
+TEST_CASE("astc-cache")
+{
+	auto map = atk::MagickImage{"png/map.png"};
+	map.convert(atk::Format::RGBA);
+
+	atk::AstcCache cache{"astc/cache"};
+
+	atk::EncodeOptions options;
+	options.cache = &cache;
+
+	// Start from a missing entry
+	auto key = atk::AstcCache::get_key(map, options);
+	std::remove(("astc/cache/" + key.substr(0, 2) + "/" + key).c_str());
+
+	auto encoded = atk::Astc::encode_from(map, options);
+	REQUIRE(cache.get_miss_count() == 1);
+	REQUIRE(cache.get_hit_count() == 0);
+
+	auto cached = atk::Astc::encode_from(map, options);
+	REQUIRE(cache.get_hit_count() == 1);
+	REQUIRE(cached.get_size() == encoded.get_size());
+	REQUIRE(std::equal(cached.get_data(), cached.get_data() + cached.get_size(), encoded.get_data()));
+
+	SECTION("options-change-the-key")
+	{
+		options.preset = atk::Preset::Fast;
+		REQUIRE(atk::AstcCache::get_key(map, options) != key);
+
+		options.preset    = atk::Preset::Thorough;
+		options.block_dim = {4, 4, 1};
+		REQUIRE(atk::AstcCache::get_key(map, options) != key);
+	}
+}
+
+TEST_CASE("astc-cache-eviction")
+{
+	// A third entry of 1 KiB overflows the cache, and evicting down to three quarters of it removes only one
+	atk::AstcCache cache{"astc/cache-eviction", 3000};
+
+	std::vector<std::string> keys{"0000000000000001", "0000000000000002", "0000000000000003"};
+
+	// Start from an empty cache
+	for (auto &key : keys)
+	{
+		std::remove(("astc/cache-eviction/00/" + key).c_str());
+	}
+
+	// Modification times only change once per tick of the system clock
+	auto wait = [] { std::this_thread::sleep_for(std::chrono::milliseconds(20)); };
+
+	uint8_t blocks[1024] = {};
+	cache.store(keys[0], blocks, sizeof(blocks));
+	wait();
+	cache.store(keys[1], blocks, sizeof(blocks));
+	wait();
+
+	// Using the first entry leaves the second one as the least recently used
+	REQUIRE(cache.load(keys[0], blocks, sizeof(blocks)));
+	wait();
+	cache.store(keys[2], blocks, sizeof(blocks));
+
+	REQUIRE(cache.load(keys[0], blocks, sizeof(blocks)));
+	REQUIRE_FALSE(cache.load(keys[1], blocks, sizeof(blocks)));
+	REQUIRE(cache.load(keys[2], blocks, sizeof(blocks)));
+}
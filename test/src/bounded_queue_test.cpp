@@ -0,0 +1,74 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+#include <atk/bounded_queue.h>
+
+TEST_CASE("bounded-queue-keeps-order")
+{
+	atk::BoundedQueue<std::unique_ptr<int>> queue{2};
+
+	const int count = 1000;
+
+	std::thread producer{[&queue] {
+		for (int i = 0; i < count; ++i)
+		{
+			queue.push(std::unique_ptr<int>{new int{i}});
+		}
+		queue.close();
+	}};
+
+	int                  expected = 0;
+	std::unique_ptr<int> item;
+	while (queue.pop(item))
+	{
+		REQUIRE(*item == expected);
+		++expected;
+	}
+	REQUIRE(expected == count);
+
+	producer.join();
+}
+
+TEST_CASE("bounded-queue-waits-for-room")
+{
+	atk::BoundedQueue<int> queue{1};
+	REQUIRE(queue.push(1));
+
+	std::atomic<bool> pushed{false};
+	std::thread       producer{[&queue, &pushed] {
+		queue.push(2);
+		pushed = true;
+	}};
+
+	// The second item waits until the first one is taken
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	REQUIRE(!pushed);
+
+	int item = 0;
+	REQUIRE(queue.pop(item));
+	REQUIRE(item == 1);
+
+	producer.join();
+	REQUIRE(pushed);
+	REQUIRE(queue.pop(item));
+	REQUIRE(item == 2);
+}
+
+TEST_CASE("bounded-queue-close")
+{
+	atk::BoundedQueue<int> queue{4};
+	REQUIRE(queue.push(1));
+	queue.close();
+
+	// Items left are still taken, new ones are refused
+	REQUIRE(!queue.push(2));
+
+	int item = 0;
+	REQUIRE(queue.pop(item));
+	REQUIRE(item == 1);
+	REQUIRE(!queue.pop(item));
+}
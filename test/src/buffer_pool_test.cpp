@@ -0,0 +1,87 @@
+#include <cstdint>
+
+#include <catch2/catch.hpp>
+
+#include <atk/buffer_pool.h>
+
+TEST_CASE("buffer-pool-reuses-buffers")
+{
+	atk::BufferPool pool;
+
+	const uint8_t *data = nullptr;
+	{
+		auto storage = pool.allocate(1000);
+		REQUIRE(storage->get_size() == 1000);
+		REQUIRE(reinterpret_cast<uintptr_t>(storage->get_data()) % atk::BufferPool::alignment == 0);
+		data = storage->get_data();
+
+		auto stats = pool.get_stats();
+		REQUIRE(stats.allocation_count == 1);
+		REQUIRE(stats.system_allocation_count == 1);
+		REQUIRE(stats.used_size >= 1000);
+		REQUIRE(stats.cached_size == 0);
+	}
+
+	REQUIRE(pool.get_stats().used_size == 0);
+	REQUIRE(pool.get_stats().cached_size > 0);
+
+	SECTION("same-size-class")
+	{
+		auto storage = pool.allocate(900);
+		REQUIRE(storage->get_data() == data);
+
+		auto stats = pool.get_stats();
+		REQUIRE(stats.allocation_count == 2);
+		REQUIRE(stats.reuse_count == 1);
+		REQUIRE(stats.system_allocation_count == 1);
+	}
+
+	SECTION("other-size-class")
+	{
+		auto storage = pool.allocate(size_t(1) << 20);
+		REQUIRE(pool.get_stats().system_allocation_count == 2);
+		REQUIRE(pool.get_stats().peak_used_size >= size_t(1) << 20);
+	}
+
+	SECTION("trim")
+	{
+		pool.trim();
+		REQUIRE(pool.get_stats().cached_size == 0);
+
+		auto storage = pool.allocate(1000);
+		REQUIRE(pool.get_stats().system_allocation_count == 2);
+	}
+}
+
+TEST_CASE("buffer-pool-limits-cached-size")
+{
+	atk::BufferPool pool{size_t(1) << 20};
+
+	{
+		auto a = pool.allocate(size_t(512) << 10);
+		auto b = pool.allocate(size_t(768) << 10);
+	}
+
+	// Only the most recent buffer fits
+	REQUIRE(pool.get_stats().cached_size <= size_t(1) << 20);
+
+	{
+		// Larger than the whole cache, it goes back to the system
+		auto c = pool.allocate(size_t(4) << 20);
+	}
+	REQUIRE(pool.get_stats().cached_size <= size_t(1) << 20);
+}
+
+TEST_CASE("buffer-pool-huge-pages")
+{
+	atk::BufferPool pool;
+	pool.set_huge_page_threshold(size_t(4) << 20);
+
+	auto storage = pool.allocate(size_t(6) << 20);
+	REQUIRE(reinterpret_cast<uintptr_t>(storage->get_data()) % atk::BufferPool::alignment == 0);
+
+	// Memory is writable all the way
+	storage->get_buffer()[0]                        = 1;
+	storage->get_buffer()[storage->get_size() - 1] = 2;
+	REQUIRE(storage->get_data()[storage->get_size() - 1] == 2);
+}
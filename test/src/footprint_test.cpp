@@ -0,0 +1,86 @@
+#include <algorithm>
+
+#include <catch2/catch.hpp>
+
+#include <atk/footprint.h>
+#include <atk/magick.h>
+
+TEST_CASE("sample-tiles")
+{
+	const uint32_t width  = 1000;
+	const uint32_t height = 700;
+
+	// Each texel holds its coordinates
+	auto size = size_t(width) * height * 3;
+	auto data = new uint8_t[size];
+	for (uint32_t y = 0; y < height; ++y)
+	{
+		for (uint32_t x = 0; x < width; ++x)
+		{
+			auto texel = data + (size_t(y) * width + x) * 3;
+			texel[0]   = uint8_t(x);
+			texel[1]   = uint8_t(y);
+			texel[2]   = uint8_t(x >> 8);
+		}
+	}
+	atk::Image image{data, size, width, height, 1, GL_RGB};
+
+	auto proxy = atk::sample_tiles(image);
+	REQUIRE(proxy.get_width() == 480);
+	REQUIRE(proxy.get_height() == 480);
+	REQUIRE(proxy.get_size() == size_t(480) * 480 * 4);
+
+	// The image keeps its format
+	REQUIRE(image.get_gl_format() == GL_RGB);
+	REQUIRE(image.get_size() == size);
+
+	// First tile is the top left corner, last tile the bottom right one
+	auto texels = proxy.get_data();
+	REQUIRE(texels[0] == 0);
+	REQUIRE(texels[1] == 0);
+	REQUIRE(texels[3] == 0xFF);
+
+	auto last = texels + proxy.get_size() - 4;
+	REQUIRE(last[0] == uint8_t(width - 1));
+	REQUIRE(last[1] == uint8_t(height - 1));
+	REQUIRE(last[2] == uint8_t((width - 1) >> 8));
+
+	// Small images are copied whole
+	auto map       = atk::MagickImage{"png/map.png"};
+	auto map_proxy = atk::sample_tiles(map);
+	REQUIRE(map_proxy.get_width() == map.get_width());
+	REQUIRE(map_proxy.get_height() == map.get_height());
+	map.convert(atk::Format::RGBA);
+	REQUIRE(std::equal(map_proxy.get_data(), map_proxy.get_data() + map_proxy.get_size(), map.get_data()));
+}
+
+TEST_CASE("footprint-candidates")
+{
+	// The first footprint meeting a target is the cheapest only if each one holds at most the texels of the previous one
+	auto &footprints = atk::get_footprint_candidates();
+	for (size_t i = 1; i < footprints.size(); ++i)
+	{
+		REQUIRE(footprints[i].x * footprints[i].y <= footprints[i - 1].x * footprints[i - 1].y);
+	}
+}
+
+TEST_CASE("select-footprint")
+{
+	auto map = atk::MagickImage{"png/map.png"};
+
+	atk::EncodeOptions options;
+	options.preset = atk::Preset::Fastest;
+
+	// Any footprint meets a low target
+	auto choice = atk::select_footprint(map, 1.0, options);
+	REQUIRE(choice.met);
+	REQUIRE(choice.block_dim.x == 12);
+	REQUIRE(choice.block_dim.y == 12);
+
+	// None meets an impossible one
+	choice = atk::select_footprint(map, 1000.0, options);
+	REQUIRE(!choice.met);
+	REQUIRE(choice.block_dim.x == 4);
+	REQUIRE(choice.block_dim.y == 4);
+	REQUIRE(choice.psnr > 0.0);
+}
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <atk/astc.h>
+#include <atk/ktx.h>
+#include <atk/ktx_reader.h>
+
+/// @return The RGBA8 texels of an astc image decoded block after block by the codec,
+///         as astc images were decoded before they were decoded in parallel
+std::vector<uint8_t> decode_with_codec(atk::Astc &astc)
+{
+	auto block_dim = atk::get_block_dim(astc.get_gl_format());
+	atk::prepare_astc_tables(block_dim);
+
+	int width  = static_cast<int>(astc.get_width());
+	int height = static_cast<int>(astc.get_height());
+	int depth  = static_cast<int>(astc.get_depth());
+
+	auto codec_image = allocate_image(8, width, height, depth, 0);
+	initialize_image(codec_image);
+
+	auto           decode_mode = atk::is_srgb(astc.get_gl_format()) ? DECODE_LDR_SRGB : DECODE_LDR;
+	swizzlepattern swizzle     = {0, 1, 2, 3};
+
+	int xblocks = (width + block_dim.x - 1) / block_dim.x;
+	int yblocks = (height + block_dim.y - 1) / block_dim.y;
+	int zblocks = (depth + block_dim.z - 1) / block_dim.z;
+
+	imageblock pb;
+	for (int z = 0; z < zblocks; z++)
+	{
+		for (int y = 0; y < yblocks; y++)
+		{
+			for (int x = 0; x < xblocks; x++)
+			{
+				auto offset = size_t((z * yblocks + y) * xblocks + x) * 16;
+				auto pcb    = *reinterpret_cast<const physical_compressed_block *>(astc.get_data() + offset);
+
+				symbolic_compressed_block scb;
+				physical_to_symbolic(block_dim.x, block_dim.y, block_dim.z, pcb, &scb);
+				decompress_symbolic_block(decode_mode, block_dim.x, block_dim.y, block_dim.z, x * block_dim.x, y * block_dim.y, z * block_dim.z, &scb, &pb);
+				write_imageblock(codec_image, &pb, block_dim.x, block_dim.y, block_dim.z, x * block_dim.x, y * block_dim.y, z * block_dim.z, swizzle);
+			}
+		}
+	}
+
+	auto data   = codec_image->imagedata8[0][0];
+	auto texels = std::vector<uint8_t>(data, data + size_t(width) * height * depth * 4);
+	destroy_image(codec_image);
+	return texels;
+}
+
+TEST_CASE("ktx-reader-uncompressed")
+{
+	atk::KtxReader reader{"ktx/map.png.ktx"};
+	REQUIRE(reader.get_width() == 99);
+	REQUIRE(reader.get_height() == 200);
+	REQUIRE(reader.get_level_count() == 8);
+	REQUIRE(reader.get_face_count() == 1);
+
+	// Same texels as loading the whole file
+	auto image = reader.get_image();
+	auto ktx   = atk::Ktx{"ktx/map.png.ktx"};
+	auto base  = ktx.get_image();
+	REQUIRE(image->get_size() == base->get_size());
+	REQUIRE(std::equal(image->get_data(), image->get_data() + image->get_size(), base->get_data()));
+
+	SECTION("level-views-share-the-mapping")
+	{
+		auto level = reader.get_image(3);
+		REQUIRE(level->get_width() == 12);
+		REQUIRE(level->get_height() == 25);
+		REQUIRE(level->get_storage() == image->get_storage());
+	}
+
+	SECTION("out-of-range")
+	{
+		REQUIRE_THROWS_AS(reader.get_image(8), std::out_of_range);
+		REQUIRE_THROWS_AS(reader.get_image(0, 0, 1), std::out_of_range);
+	}
+}
+
+TEST_CASE("ktx-reader-astc-thumbnail")
+{
+	atk::KtxReader reader{"ktx/lenna.png.astc.ktx"};
+	REQUIRE(reader.get_level_count() == 10);
+
+	auto level = reader.find_level(128);
+	REQUIRE(level == 2);
+	REQUIRE(reader.find_level(0) == 9);
+
+	auto thumbnail = reader.get_image(level);
+	REQUIRE(dynamic_cast<atk::Astc *>(thumbnail.get()));
+	REQUIRE(thumbnail->get_width() == 128);
+	REQUIRE(thumbnail->get_height() == 128);
+	REQUIRE(thumbnail->get_size() == 16 * 16 * 16);
+
+	auto &astc   = dynamic_cast<atk::Astc &>(*thumbnail);
+	auto  texels = astc.decode();
+	REQUIRE(texels.get_size() == 128 * 128 * 4);
+
+	// Same texels as the codec decoding one block at a time
+	auto reference = decode_with_codec(astc);
+	REQUIRE(reference.size() == texels.get_size());
+	REQUIRE(std::equal(reference.begin(), reference.end(), texels.get_data()));
+}
+
+TEST_CASE("ktx-reader-not-ktx")
+{
+	REQUIRE_THROWS_AS(atk::KtxReader{"astc/map.astc"}, std::runtime_error);
+}
@@ -1,8 +1,13 @@
+#include <algorithm>
+#include <memory>
+
 #include <catch2/catch.hpp>
 
 #include <atk/astc.h>
 #include <atk/ktx.h>
+#include <atk/ktx_reader.h>
 #include <atk/magick.h>
+#include <atk/metrics.h>
 #include <atk/texture.h>
 
 TEST_CASE("ktx-npot")
@@ -22,7 +27,7 @@ TEST_CASE("ktx-npot-magick-mipmaps")
 	auto png_npot_path = "png/map.png";
 	auto png           = std::make_unique<atk::MagickImage>(png_npot_path);
 	auto texture       = atk::Texture{std::move(png)};
-	texture.generate_mipmap_chain();
+	texture.generate_mipmap_chain(atk::MipmapGenerator::Magick);
 
 	SECTION("create-ktx-from-magick")
 	{
@@ -74,6 +79,24 @@ TEST_CASE("ktx-flow")
 	}
 }
 
+TEST_CASE("ktx-image-outlives-texture")
+{
+	std::unique_ptr<atk::Image> image;
+	{
+		auto ktx = atk::Ktx{"ktx/map.png.ktx"};
+		image    = ktx.get_image();
+	}
+
+	// Texels are copied out of the data libktx allocated and freed
+	atk::KtxReader reader{"ktx/map.png.ktx"};
+	auto           base = reader.get_image();
+	REQUIRE(image->get_width() == base->get_width());
+	REQUIRE(image->get_size() >= base->get_size());
+	REQUIRE(std::equal(base->get_data(), base->get_data() + base->get_size(), image->get_data()));
+
+	image.reset();
+}
+
 TEST_CASE("decode-astc")
 {
 	auto ktx   = atk::Ktx{"ktx/map.png.astc.ktx"};
@@ -84,9 +107,9 @@ TEST_CASE("decode-astc")
 
 	auto png = atk::MagickImage{"png/map.png"};
 	png.convert(atk::Format::RGBA);
-	auto diff = decoded.diff(png);
-	std::cout << "Decoded diff astc [" << diff << "]" << std::endl;
-	assert(diff < 0.5f);
+	auto psnr = atk::measure(png, decoded).get_psnr();
+	std::cout << "Decoded astc PSNR [" << psnr << "]" << std::endl;
+	assert(psnr > 25.0);
 
 	png.get_image().magick("PNG");
 	png.store("png/map.astc.png");
@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <atk/astc.h>
+#include <atk/ktx.h>
+#include <atk/ktx_reader.h>
+#include <atk/ktx_writer.h>
+#include <atk/magick.h>
+#include <atk/texture.h>
+
+TEST_CASE("ktx-writer-layout")
+{
+	// Rows of 3 RGB texels are padded to 12 bytes
+	auto data  = new uint8_t[3 * 2 * 3];
+	auto image = atk::Image{data, 3 * 2 * 3, 3, 2, 1, GL_RGB};
+	std::fill(data, data + image.get_size(), 0x7F);
+
+	atk::KtxWriter writer{GL_RGB, 3, 2, 1};
+	writer.open();
+	writer.set_image(0, image);
+
+	REQUIRE(writer.get_image_size(0) == 12 * 2);
+	REQUIRE(writer.get_size() == 64 + 4 + 12 * 2);
+
+	auto level = writer.get_image_data(0);
+	REQUIRE(level == writer.get_data() + 64 + 4);
+	REQUIRE(level[8] == 0x7F);
+	REQUIRE(level[9] == 0);
+	REQUIRE(level[12] == 0x7F);
+}
+
+TEST_CASE("ktx-writer-astc")
+{
+	auto png     = std::make_unique<atk::MagickImage>("png/map.png");
+	auto texture = atk::Texture{std::move(png)};
+	texture.generate_mipmap_chain();
+
+	atk::write_astc_ktx(texture, "ktx/map.png.astc.ktx");
+
+	auto ktx = atk::Ktx{"ktx/map.png.astc.ktx"};
+	REQUIRE(ktx.get_level_count() == texture.get_levels());
+	REQUIRE(ktx.get_width() == texture->get_width());
+	REQUIRE(ktx.get_height() == texture->get_height());
+
+	// Same blocks as encoding the base level on its own
+	auto image   = ktx.get_image();
+	auto png_map = atk::MagickImage{"png/map.png"};
+	png_map.convert(atk::Format::RGBA);
+	auto astc = atk::Astc::encode_from(png_map);
+	REQUIRE(std::equal(astc.get_data(), astc.get_data() + astc.get_size(), image->get_data()));
+}
+
+TEST_CASE("ktx-writer-astc-footprint")
+{
+	auto png     = std::make_unique<atk::MagickImage>("png/map.png");
+	auto texture = atk::Texture{std::move(png)};
+	texture.generate_mipmap_chain();
+
+	atk::EncodeOptions options;
+	options.block_dim = {6, 6, 1};
+	atk::write_astc_ktx(texture, "ktx/map.png.astc-6x6.ktx", options);
+
+	atk::KtxReader reader{"ktx/map.png.astc-6x6.ktx"};
+	REQUIRE(reader.get_gl_format() == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR);
+
+	auto image = reader.get_image(1);
+	REQUIRE(image->get_gl_format() == GL_COMPRESSED_SRGB8_ALPHA8_ASTC_6x6_KHR);
+	REQUIRE(dynamic_cast<atk::Astc &>(*image).get_xblocks() == (texture.get_mipmap_chain()[0]->get_width() + 5) / 6);
+}
+
+TEST_CASE("ktx-writer-cubemap-layout")
+{
+	// Faces of a non array cubemap have rows of 3 RGB texels padded to 12 bytes
+	atk::KtxWriter writer{GL_RGB, 3, 3, 1, 1, 6};
+	writer.open();
+
+	REQUIRE(writer.get_image_size(0) == 12 * 3);
+	REQUIRE(writer.get_size() == 64 + 4 + 12 * 3 * 6);
+	REQUIRE(writer.get_image_data(0, 0, 1) == writer.get_image_data(0) + 12 * 3);
+	REQUIRE_THROWS_AS(writer.get_image_data(0, 1, 0), std::out_of_range);
+
+	// Image size field holds a single face
+	uint32_t image_size = 0;
+	std::memcpy(&image_size, writer.get_data() + 64, sizeof(image_size));
+	REQUIRE(image_size == 12 * 3);
+}
+
+TEST_CASE("ktx-writer-astc-cubemap")
+{
+	std::vector<std::unique_ptr<atk::Image>> faces;
+	for (int i = 0; i < 6; ++i)
+	{
+		faces.emplace_back(new atk::MagickImage{i % 2 ? "png/lenna-npot-from-astc.png" : "png/lenna-npot.png"});
+	}
+	auto texture = atk::Texture{std::move(faces), 1, 6};
+	texture.generate_mipmap_chain();
+
+	atk::EncodeOptions options;
+	options.preset    = atk::Preset::Fastest;
+	options.block_dim = {6, 6, 1};
+	atk::write_astc_ktx(texture, "ktx/lenna-npot-cubemap.ktx", options);
+
+	atk::KtxReader reader{"ktx/lenna-npot-cubemap.ktx"};
+	REQUIRE(reader.get_face_count() == 6);
+	REQUIRE(reader.get_layer_count() == 1);
+	REQUIRE(reader.get_level_count() == texture.get_levels());
+
+	// Same blocks as encoding a face on its own
+	auto png = atk::MagickImage{"png/lenna-npot-from-astc.png"};
+	png.convert(atk::Format::RGBA);
+	auto astc  = atk::Astc::encode_from(png, options);
+	auto image = reader.get_image(0, 0, 3);
+	REQUIRE(image->get_size() == astc.get_size());
+	REQUIRE(std::equal(astc.get_data(), astc.get_data() + astc.get_size(), image->get_data()));
+}
+
+TEST_CASE("ktx-writer-array")
+{
+	std::vector<std::unique_ptr<atk::Image>> layers;
+	layers.emplace_back(new atk::MagickImage{"png/lenna.png"});
+	layers.emplace_back(new atk::MagickImage{"png/lenna-alpha.png"});
+	for (auto &layer : layers)
+	{
+		layer->convert(atk::Format::RGBA);
+	}
+	auto texture = atk::Texture{std::move(layers), 2};
+
+	atk::write_ktx(texture, "ktx/lenna-array.ktx");
+
+	atk::KtxReader reader{"ktx/lenna-array.ktx"};
+	REQUIRE(reader.get_layer_count() == 2);
+	REQUIRE(reader.get_face_count() == 1);
+
+	auto  image = reader.get_image(0, 1);
+	auto &layer = texture.get_level(0, 1);
+	REQUIRE(image->get_size() == layer.get_size());
+	REQUIRE(std::equal(image->get_data(), image->get_data() + image->get_size(), layer.get_data()));
+}
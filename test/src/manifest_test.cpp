@@ -0,0 +1,77 @@
+#include <cstdio>
+
+#include <catch2/catch.hpp>
+
+#include <atk/manifest.h>
+
+TEST_CASE("manifest")
+{
+	std::remove("ktx/test.manifest");
+
+	atk::Manifest::Entry entry;
+	entry.input      = "png/map.png";
+	entry.input_hash = atk::Manifest::hash_file("png/map.png");
+	entry.options    = "mipmaps=native";
+	entry.version    = "1.0.0";
+
+	REQUIRE(entry.input_hash == atk::Manifest::hash_file("png/map.png"));
+	REQUIRE(entry.input_hash != atk::Manifest::hash_file("png/lenna.png"));
+
+	{
+		atk::Manifest manifest{"ktx/test.manifest"};
+		REQUIRE(!manifest.is_up_to_date("ktx/map.png.ktx", entry));
+
+		manifest.set("ktx/map.png.ktx", entry);
+		manifest.set("ktx/missing.ktx", entry);
+		manifest.save();
+	}
+
+	atk::Manifest manifest{"ktx/test.manifest"};
+	REQUIRE(manifest.is_up_to_date("ktx/map.png.ktx", entry));
+
+	SECTION("missing-output")
+	{
+		REQUIRE(!manifest.is_up_to_date("ktx/missing.ktx", entry));
+	}
+
+	SECTION("options-changed")
+	{
+		entry.options = "mipmaps=magick";
+		REQUIRE(!manifest.is_up_to_date("ktx/map.png.ktx", entry));
+	}
+
+	SECTION("version-changed")
+	{
+		entry.version = "1.0.1";
+		REQUIRE(!manifest.is_up_to_date("ktx/map.png.ktx", entry));
+	}
+}
+
+TEST_CASE("manifest-shared")
+{
+	std::remove("ktx/shared.manifest");
+
+	atk::Manifest::Entry entry;
+	entry.input      = "png/map.png";
+	entry.input_hash = atk::Manifest::hash_file("png/map.png");
+	entry.options    = "mipmaps=native";
+	entry.version    = "1.0.0";
+
+	{
+		// Jobs of a server using the same path at once
+		auto first  = atk::Manifest::get_shared("ktx/shared.manifest");
+		auto second = atk::Manifest::get_shared("ktx/shared.manifest");
+		REQUIRE(first == second);
+
+		first->set("ktx/map.png.ktx", entry);
+		second->set("ktx/other.ktx", entry);
+		first->save();
+	}
+
+	// Loaded again once no job uses it
+	auto manifest = atk::Manifest::get_shared("ktx/shared.manifest");
+	REQUIRE(manifest->is_up_to_date("ktx/map.png.ktx", entry));
+
+	atk::Manifest saved{"ktx/shared.manifest"};
+	REQUIRE(saved.is_up_to_date("ktx/map.png.ktx", entry));
+}
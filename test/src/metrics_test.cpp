@@ -0,0 +1,86 @@
+#include <cmath>
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+
+#include <atk/metrics.h>
+
+/// @return A new image with every channel of every texel set to a value
+atk::Image create_image(uint32_t width, uint32_t height, uint32_t channels, uint8_t value)
+{
+	auto size = size_t(width) * height * channels;
+	auto data = new uint8_t[size];
+	std::fill(data, data + size, value);
+	return atk::Image{data, size, width, height, 1, channels == 4 ? uint32_t(GL_RGBA) : uint32_t(GL_RGB)};
+}
+
+TEST_CASE("metrics-same-image")
+{
+	auto a = create_image(37, 21, 4, 200);
+	auto b = create_image(37, 21, 4, 200);
+
+	auto metrics = atk::measure(a, b);
+	REQUIRE(metrics.channel_count == 4);
+	REQUIRE(metrics.get_mse() == 0.0);
+	REQUIRE(std::isinf(metrics.get_psnr()));
+	REQUIRE(metrics.get_max_error() == 0);
+	REQUIRE(metrics.get_ssim() == Approx(1.0));
+}
+
+TEST_CASE("metrics-channel-error")
+{
+	auto a = create_image(64, 40, 3, 100);
+	auto b = create_image(64, 40, 3, 100);
+
+	// Values above 127 are measured as they are
+	auto data = const_cast<uint8_t *>(b.get_data());
+	for (size_t i = 0; i < b.get_size(); i += 3)
+	{
+		data[i] = 210;
+	}
+
+	auto metrics = atk::measure(a, b);
+	REQUIRE(metrics.channel_count == 3);
+	REQUIRE(metrics.mse[0] == Approx(110.0 * 110.0));
+	REQUIRE(metrics.mse[1] == 0.0);
+	REQUIRE(metrics.max_error[0] == 110);
+	REQUIRE(metrics.get_max_error() == 110);
+	REQUIRE(metrics.psnr[0] == Approx(atk::get_psnr(110.0 * 110.0)));
+	REQUIRE(metrics.get_psnr() == Approx(atk::get_psnr(110.0 * 110.0 / 3)));
+	REQUIRE(metrics.ssim[0] < 1.0);
+	REQUIRE(metrics.ssim[1] == Approx(1.0));
+}
+
+TEST_CASE("metrics-block-error")
+{
+	auto a = create_image(10, 70, 4, 0);
+	auto b = create_image(10, 70, 4, 0);
+
+	// Error in the last texel, which lies in a partial block
+	auto data              = const_cast<uint8_t *>(b.get_data());
+	data[b.get_size() - 4] = 8;
+
+	atk::MetricsOptions options;
+	options.ssim         = false;
+	options.block_width  = 4;
+	options.block_height = 4;
+
+	auto metrics = atk::measure(a, b, options);
+	REQUIRE(metrics.block_columns == 3);
+	REQUIRE(metrics.block_rows == 18);
+	REQUIRE(metrics.block_mse.size() == 3 * 18);
+	REQUIRE(metrics.block_mse.back() == Approx(64.0 / (2 * 2 * 4)));
+	REQUIRE(metrics.block_mse.front() == 0.0);
+	REQUIRE(metrics.ssim[0] == 0.0);
+	REQUIRE(metrics.mse[0] == Approx(64.0 / (10 * 70)));
+}
+
+TEST_CASE("metrics-mismatch")
+{
+	auto a = create_image(8, 8, 4, 0);
+	auto b = create_image(8, 4, 4, 0);
+	auto c = create_image(8, 8, 3, 0);
+
+	REQUIRE_THROWS_AS(atk::measure(a, b), std::runtime_error);
+	REQUIRE_THROWS_AS(atk::measure(a, c), std::runtime_error);
+}
@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <atk/mipmap.h>
+#include <atk/texture.h>
+
+/// @return A new raw image filled with texels
+std::unique_ptr<atk::Image> create_image(uint32_t width, uint32_t height, uint32_t gl_format, std::vector<uint8_t> texels)
+{
+	auto data = new uint8_t[texels.size()];
+	std::copy(std::begin(texels), std::end(texels), data);
+	return std::unique_ptr<atk::Image>{new atk::Image{data, texels.size(), width, height, 1, gl_format}};
+}
+
+TEST_CASE("native-mipmaps")
+{
+	SECTION("odd-size")
+	{
+		// Three texels are filtered with the same weight
+		auto image  = create_image(3, 1, GL_RGB, {30, 30, 30, 60, 60, 60, 90, 90, 90});
+		auto mipmap = atk::generate_mipmap(*image);
+
+		REQUIRE(mipmap->get_width() == 1);
+		REQUIRE(mipmap->get_height() == 1);
+		REQUIRE(mipmap->get_gl_format() == GL_RGB);
+		REQUIRE(mipmap->get_data()[0] == 60);
+	}
+
+	SECTION("srgb-is-filtered-in-linear-space")
+	{
+		auto image  = create_image(2, 1, GL_SRGB8_ALPHA8, {0, 0, 0, 0, 255, 255, 255, 255});
+		auto mipmap = atk::generate_mipmap(*image);
+
+		// Half intensity is 188 in sRGB, while alpha is linear
+		REQUIRE(mipmap->get_data()[0] == 188);
+		REQUIRE(mipmap->get_data()[3] == 128);
+	}
+
+	SECTION("chain")
+	{
+		auto texels  = std::vector<uint8_t>(5 * 3 * 4, 200);
+		auto texture = atk::Texture{create_image(5, 3, GL_SRGB8_ALPHA8, texels)};
+		texture.generate_mipmap_chain();
+
+		auto &chain = texture.get_mipmap_chain();
+		REQUIRE(chain.size() == 2);
+		REQUIRE(chain[0]->get_width() == 2);
+		REQUIRE(chain[0]->get_height() == 1);
+		REQUIRE(chain[1]->get_width() == 1);
+		REQUIRE(chain[1]->get_height() == 1);
+
+		// A constant image stays constant
+		auto data = chain[1]->get_data();
+		REQUIRE(std::all_of(data, data + chain[1]->get_size(), [](uint8_t texel) { return texel == 200; }));
+	}
+}
@@ -1,6 +1,7 @@
 #include <cassert>
 #include <iostream>
 #include <stdexcept>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -56,3 +57,32 @@ TEST_CASE("should-not-load-non-png")
 		std::cout << "[OK] " << e.what() << '\n';
 	}
 }
+
+TEST_CASE("export-png-pixels")
+{
+	auto image = atk::MagickImage{"png/lenna.png"};
+	auto size  = size_t(image.get_width()) * image.get_height();
+
+	// Querying the format does not change the layout
+	REQUIRE(image.get_gl_format() == GL_SRGB8);
+	REQUIRE(image.get_gl_format() == GL_SRGB8);
+	REQUIRE(image.get_size() == size * 3);
+
+	auto rgb = std::vector<uint8_t>(image.get_data(), image.get_data() + image.get_size());
+
+	// Same data on following accesses
+	REQUIRE(image.get_data() == image.get_data());
+
+	image.convert(atk::Format::RGBA);
+	REQUIRE(image.get_gl_format() == GL_SRGB8_ALPHA8);
+	REQUIRE(image.get_size() == size * 4);
+
+	auto rgba = image.get_data();
+	for (size_t i = 0; i < size; ++i)
+	{
+		REQUIRE(rgba[i * 4] == rgb[i * 3]);
+		REQUIRE(rgba[i * 4 + 1] == rgb[i * 3 + 1]);
+		REQUIRE(rgba[i * 4 + 2] == rgb[i * 3 + 2]);
+		REQUIRE(rgba[i * 4 + 3] == 255);
+	}
+}
@@ -0,0 +1,193 @@
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#if !defined(_WIN32)
+#	include <sys/socket.h>
+#	include <sys/un.h>
+#	include <unistd.h>
+#endif
+
+#include <catch2/catch.hpp>
+
+#include <atk/server.h>
+#include <atk/util.h>
+
+/// Lets the jobs asked to wait finish
+std::atomic<bool> release_jobs{false};
+
+/// @brief Answers with the number of arguments, and fails or waits when asked to
+atk::ServerResponse count_args(const std::vector<std::string> &args)
+{
+	if (!args.empty() && args[0] == "fail")
+	{
+		throw std::runtime_error{"Failed"};
+	}
+
+	while (!args.empty() && args[0] == "wait" && !release_jobs)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	atk::ServerResponse response;
+	response.fields = "\"count\": " + std::to_string(args.size());
+	if (!args.empty() && args[0] == "file")
+	{
+		response.files.emplace_back(args[1]);
+	}
+	return response;
+}
+
+TEST_CASE("server-split-args")
+{
+	auto args = atk::Server::split_args("  -c astc \"my texture.png\"\tother.png\r");
+	REQUIRE(args.size() == 4);
+	REQUIRE(args[0] == "-c");
+	REQUIRE(args[2] == "my texture.png");
+	REQUIRE(args[3] == "other.png");
+	REQUIRE(atk::Server::split_args("").empty());
+}
+
+TEST_CASE("server-serve-stream")
+{
+	atk::Server server{count_args};
+
+	auto path = atk::get_temporary_path("server-test.bin");
+	{
+		std::ofstream file{path, std::ios::binary};
+		file << "KTX";
+	}
+
+	std::istringstream requests{"a b c\n\nfail\nfile " + path + "\nstats\nquit\nignored\n"};
+	std::ostringstream answers;
+	server.serve(requests, answers);
+	std::remove(path.c_str());
+
+	std::istringstream lines{answers.str()};
+	std::string        line;
+
+	REQUIRE(std::getline(lines, line));
+	REQUIRE(line.find("{\"id\": 0, \"status\": \"ok\", \"count\": 3") == 0);
+	REQUIRE(line.find("\"job_s\": ") != std::string::npos);
+
+	REQUIRE(std::getline(lines, line));
+	REQUIRE(line.find("\"status\": \"error\", \"error\": \"Failed\"") != std::string::npos);
+
+	// Bytes of the file follow its answer
+	REQUIRE(std::getline(lines, line));
+	REQUIRE(line.find("\"sizes\": [3]}") != std::string::npos);
+	REQUIRE(std::getline(lines, line));
+	REQUIRE(line.find("KTX{\"queue_depth\": 0") == 0);
+	REQUIRE(line.find("\"completed\": 3, \"failed\": 1") != std::string::npos);
+
+	// Nothing after quit
+	REQUIRE(!std::getline(lines, line));
+
+	auto stats = server.get_stats();
+	REQUIRE(stats.completed_count == 3);
+	REQUIRE(stats.latency_p99_s >= stats.latency_p50_s);
+}
+
+#if !defined(_WIN32)
+/// @return A client connected to the socket, negative if the server never listened
+int connect_client(const std::string &path)
+{
+	sockaddr_un address = {};
+	address.sun_family  = AF_UNIX;
+	std::copy(std::begin(path), std::end(path), address.sun_path);
+
+	// Wait for the socket
+	int client = -1;
+	for (int attempt = 0; attempt < 100 && client < 0; ++attempt)
+	{
+		client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (::connect(client, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+		{
+			::close(client);
+			client = -1;
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+	return client;
+}
+
+/// @return Everything received until the server disconnects
+std::string receive_all(const int client)
+{
+	std::string answers;
+	char        chunk[256];
+	ssize_t     count;
+	while ((count = ::recv(client, chunk, sizeof(chunk), 0)) > 0)
+	{
+		answers.append(chunk, count);
+	}
+	return answers;
+}
+
+TEST_CASE("server-listen")
+{
+	atk::Server server{count_args};
+
+	auto path = atk::get_temporary_path("server-test.sock");
+
+	std::thread listener{[&server, &path] { server.listen(path); }};
+
+	auto client = connect_client(path);
+	REQUIRE(client >= 0);
+
+	std::string request = "x y\nshutdown\n";
+	REQUIRE(::send(client, request.data(), request.size(), 0) == ssize_t(request.size()));
+
+	auto answers = receive_all(client);
+	::close(client);
+
+	listener.join();
+
+	REQUIRE(answers.find("\"count\": 2") != std::string::npos);
+	REQUIRE(answers.find("{\"status\": \"shutdown\"}\n") != std::string::npos);
+}
+
+TEST_CASE("server-shutdown-answers-other-clients")
+{
+	atk::Server server{count_args};
+
+	auto path = atk::get_temporary_path("server-test.sock");
+
+	std::thread listener{[&server, &path] { server.listen(path); }};
+
+	auto waiting = connect_client(path);
+	REQUIRE(waiting >= 0);
+
+	// A job of the first client is running when the second one shuts the server down
+	release_jobs        = false;
+	std::string request = "wait a b\n";
+	REQUIRE(::send(waiting, request.data(), request.size(), 0) == ssize_t(request.size()));
+	while (server.get_stats().running_count == 0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	auto stopping = connect_client(path);
+	REQUIRE(stopping >= 0);
+
+	request = "shutdown\n";
+	REQUIRE(::send(stopping, request.data(), request.size(), 0) == ssize_t(request.size()));
+	REQUIRE(receive_all(stopping) == "{\"status\": \"shutdown\"}\n");
+	::close(stopping);
+
+	// No new client is accepted
+	auto late = connect_client(path);
+	REQUIRE(late < 0);
+
+	release_jobs = true;
+	auto answers = receive_all(waiting);
+	::close(waiting);
+
+	listener.join();
+
+	REQUIRE(answers.find("\"status\": \"ok\", \"count\": 3") != std::string::npos);
+}
+#endif
@@ -0,0 +1,41 @@
+#include <fstream>
+#include <stdexcept>
+
+#include <catch2/catch.hpp>
+
+#include <atk/astc.h>
+#include <atk/storage.h>
+
+TEST_CASE("mapped-storage")
+{
+	atk::MappedStorage storage{"astc/map.astc"};
+
+	std::ifstream file{"astc/map.astc", std::ios::binary | std::ios::ate};
+	REQUIRE(storage.get_size() == static_cast<size_t>(file.tellg()));
+
+	// Magic number
+	REQUIRE(storage.get_data()[0] == 0x13);
+	REQUIRE(storage.get_data()[3] == 0x5C);
+}
+
+TEST_CASE("mapped-storage-missing-file")
+{
+	REQUIRE_THROWS_AS(atk::MappedStorage{"astc/missing.astc"}, std::runtime_error);
+}
+
+TEST_CASE("astc-shares-mapped-storage")
+{
+	auto astc    = atk::Astc{"astc/map.astc"};
+	auto storage = astc.get_storage();
+	REQUIRE(dynamic_cast<atk::MappedStorage *>(storage.get()));
+
+	// Blocks follow the header within the mapping
+	REQUIRE(astc.get_data() == storage->get_data() + sizeof(atk::AstcHeader));
+	REQUIRE(sizeof(atk::AstcHeader) + astc.get_size() <= storage->get_size());
+
+	SECTION("outlives-image")
+	{
+		auto moved = atk::Astc{std::move(astc)};
+		REQUIRE(moved.get_storage() == storage);
+	}
+}
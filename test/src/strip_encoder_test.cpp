@@ -0,0 +1,57 @@
+#include <algorithm>
+
+#include <catch2/catch.hpp>
+
+#include <atk/ktx_reader.h>
+#include <atk/ktx_writer.h>
+#include <atk/magick.h>
+#include <atk/storage.h>
+#include <atk/strip_encoder.h>
+#include <atk/texture.h>
+
+TEST_CASE("strip-encoder")
+{
+	auto png     = std::make_unique<atk::MagickImage>("png/map.png");
+	auto texture = atk::Texture{std::move(png)};
+	texture.generate_mipmap_chain();
+	atk::write_astc_ktx(texture, "ktx/map.png.astc.ktx");
+
+	SECTION("same-file-as-whole-levels")
+	{
+		auto image = atk::MagickImage{"png/map.png"};
+		atk::write_astc_ktx_strips(image, "ktx/map.png.strips.ktx", true);
+
+		atk::MappedStorage whole{"ktx/map.png.astc.ktx"};
+		atk::MappedStorage strips{"ktx/map.png.strips.ktx"};
+		REQUIRE(whole.get_size() == strips.get_size());
+		REQUIRE(std::equal(whole.get_data(), whole.get_data() + whole.get_size(), strips.get_data()));
+	}
+
+	SECTION("bounded-rows")
+	{
+		auto image = atk::MagickImage{"png/map.png"};
+		image.convert(atk::Format::RGBA);
+
+		auto width  = image.get_width();
+		auto height = image.get_height();
+
+		atk::KtxWriter writer{GL_COMPRESSED_SRGB8_ALPHA8_ASTC_8x8_KHR, width, height, atk::get_mipmap_level_count(width, height)};
+		writer.open();
+
+		// Rows arrive one at a time
+		atk::StripEncoder encoder{writer, width, height, image.get_gl_format(), {}, 1};
+		std::vector<uint8_t> row(width * 4);
+		for (uint32_t y = 0; y < height; ++y)
+		{
+			image.export_rows(y, 1, row.data());
+			encoder.push_rows(row.data(), 1);
+		}
+
+		REQUIRE(encoder.is_complete());
+		REQUIRE(encoder.get_peak_row_count() <= 8 + 2);
+
+		atk::MappedStorage whole{"ktx/map.png.astc.ktx"};
+		REQUIRE(writer.get_size() == whole.get_size());
+		REQUIRE(std::equal(whole.get_data(), whole.get_data() + whole.get_size(), writer.get_data()));
+	}
+}
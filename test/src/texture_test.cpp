@@ -1,3 +1,6 @@
+#include <stdexcept>
+#include <vector>
+
 #include <catch2/catch.hpp>
 
 #include <atk/astc.h>
@@ -50,3 +53,50 @@ TEST_CASE("can-create-a-png-texture")
 		}
 	}
 }
+
+TEST_CASE("can-create-an-array-texture")
+{
+	std::vector<std::unique_ptr<atk::Image>> layers;
+	layers.emplace_back(new atk::MagickImage{"png/lenna.png"});
+	layers.emplace_back(new atk::MagickImage{"png/lenna-alpha.png"});
+	auto texture = atk::Texture{std::move(layers), 2};
+
+	REQUIRE(texture.get_layer_count() == 2);
+	REQUIRE(texture.get_face_count() == 1);
+
+	texture.generate_mipmap_chain();
+	REQUIRE(texture.get_mipmap_chain(1).size() == texture.get_mipmap_chain(0).size());
+	REQUIRE(texture.get_level(1, 1).get_width() == 256);
+
+	texture.convert(atk::Format::ASTC);
+	REQUIRE(dynamic_cast<atk::Astc *>(&texture.get_level(0, 1)));
+	REQUIRE(dynamic_cast<atk::Astc *>(&texture.get_level(texture.get_levels() - 1, 1)));
+}
+
+TEST_CASE("texture-layers-and-faces-must-match")
+{
+	SECTION("different-sizes")
+	{
+		std::vector<std::unique_ptr<atk::Image>> layers;
+		layers.emplace_back(new atk::MagickImage{"png/lenna.png"});
+		layers.emplace_back(new atk::MagickImage{"png/lenna-npot.png"});
+		REQUIRE_THROWS_AS(atk::Texture(std::move(layers), 2), std::runtime_error);
+	}
+
+	SECTION("non-square-cubemap")
+	{
+		std::vector<std::unique_ptr<atk::Image>> faces;
+		for (int i = 0; i < 6; ++i)
+		{
+			faces.emplace_back(new atk::MagickImage{"png/map.png"});
+		}
+		REQUIRE_THROWS_AS(atk::Texture(std::move(faces), 1, 6), std::runtime_error);
+	}
+
+	SECTION("missing-face")
+	{
+		std::vector<std::unique_ptr<atk::Image>> faces;
+		faces.emplace_back(new atk::MagickImage{"png/lenna.png"});
+		REQUIRE_THROWS_AS(atk::Texture(std::move(faces), 1, 6), std::runtime_error);
+	}
+}
@@ -0,0 +1,66 @@
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include <atk/thread_pool.h>
+
+TEST_CASE("thread-pool")
+{
+	atk::ThreadPool pool{4};
+	REQUIRE(pool.get_thread_count() == 4);
+
+	SECTION("calls-every-index-once")
+	{
+		std::vector<std::atomic<int>> calls(1000);
+		pool.parallel_for(calls.size(), [&calls](size_t i) { ++calls[i]; });
+
+		for (auto &call : calls)
+		{
+			REQUIRE(call == 1);
+		}
+	}
+
+	SECTION("nested-loops")
+	{
+		std::atomic<size_t> sum{0};
+		pool.parallel_for(8, [&pool, &sum](size_t i) {
+			pool.parallel_for(100, [&sum](size_t j) { sum += j; });
+		});
+
+		REQUIRE(sum == 8 * 4950);
+	}
+
+	SECTION("rethrows-exceptions")
+	{
+		REQUIRE_THROWS_AS(pool.parallel_for(100, [](size_t i) {
+			if (i == 42)
+			{
+				throw std::runtime_error{"failure"};
+			}
+		}),
+		                  std::runtime_error);
+	}
+}
+
+TEST_CASE("single-thread-pool")
+{
+	atk::ThreadPool pool{1};
+	REQUIRE(pool.get_thread_count() == 1);
+
+	size_t count = 0;
+	pool.parallel_for(10, [&count](size_t i) { ++count; });
+	REQUIRE(count == 10);
+}
+
+TEST_CASE("default-thread-pool")
+{
+	REQUIRE(atk::get_available_thread_count() >= 1);
+
+	// Other tests may already use the pool, which is never replaced once running
+	auto &pool = atk::ThreadPool::get_default();
+	REQUIRE(pool.get_thread_count() == atk::get_available_thread_count());
+	REQUIRE_THROWS_AS(atk::ThreadPool::set_default_thread_count(2), std::logic_error);
+	REQUIRE(&atk::ThreadPool::get_default() == &pool);
+}
@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <catch2/catch.hpp>
+
+#include <atk/trace.h>
+
+/// @return The events of a stage, in the order they were recorded
+std::vector<atk::TraceEvent> get_stage_events(const std::string &name)
+{
+	std::vector<atk::TraceEvent> events;
+	for (auto &event : atk::Tracer::get()->get_events())
+	{
+		if (name == event.name)
+		{
+			events.emplace_back(event);
+		}
+	}
+	return events;
+}
+
+TEST_CASE("trace-scopes")
+{
+	atk::Tracer::start();
+	REQUIRE(atk::Tracer::get() != nullptr);
+
+	{
+		atk::TraceFile  file{"png/map.png"};
+		atk::TraceScope scope{"trace-test-level", 2, 16};
+		scope.set_bytes(64);
+	}
+	{
+		atk::TraceScope scope{"trace-test-level"};
+	}
+
+	auto events = get_stage_events("trace-test-level");
+	REQUIRE(events.size() == 2);
+
+	REQUIRE(events[0].file == "png/map.png");
+	REQUIRE(events[0].level == 2);
+	REQUIRE(events[0].bytes == 64);
+	REQUIRE(events[0].thread_id > 0);
+
+	// The file only applies while it lives
+	REQUIRE(events[1].file.empty());
+	REQUIRE(events[1].level == -1);
+	REQUIRE(events[1].start_ns >= events[0].start_ns + events[0].wall_ns);
+}
+
+TEST_CASE("trace-outputs")
+{
+	atk::Tracer::start();
+
+	{
+		atk::TraceFile  file{"png/\"quoted\".png"};
+		atk::TraceScope scope{"trace-test-output", 0, 128};
+	}
+
+	std::ostringstream stats;
+	atk::Tracer::get()->write_stats(stats);
+	REQUIRE(stats.str().find("\"trace-test-output\": {\"count\": 1") != std::string::npos);
+	REQUIRE(stats.str().find("{\"file\": \"png/\\\"quoted\\\".png\"") != std::string::npos);
+
+	atk::Tracer::get()->write_chrome_trace("trace-test.json");
+
+	std::ostringstream trace;
+	{
+		std::ifstream file{"trace-test.json"};
+		trace << file.rdbuf();
+	}
+	std::remove("trace-test.json");
+
+	REQUIRE(trace.str().find("\"traceEvents\"") != std::string::npos);
+	REQUIRE(trace.str().find("{\"name\": \"trace-test-output\", \"cat\": \"ktx-creator\", \"ph\": \"X\"") != std::string::npos);
+}
@@ -28,3 +28,15 @@ TEST_CASE("basename")
 		REQUIRE(get_basename_no_extension(name) == "file");
 	}
 }
+
+TEST_CASE("hash")
+{
+	using namespace atk;
+
+	const char data[] = "ktx-creator";
+	REQUIRE(get_hash(data, sizeof(data)) == get_hash(data, sizeof(data)));
+	REQUIRE(get_hash(data, sizeof(data)) != get_hash(data, sizeof(data) - 1));
+	REQUIRE(get_hash(data, sizeof(data), 1) != get_hash(data, sizeof(data)));
+
+	REQUIRE(to_hex(0x0123456789abcdefull) == "0123456789abcdef");
+}